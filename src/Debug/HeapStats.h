@@ -0,0 +1,132 @@
+#ifndef HEAPSTATS_H
+#define HEAPSTATS_H
+
+// Heap telemetry: free heap, largest free block, fragmentation and heap
+// allocations per loop(). Off by default; enable with the
+// nodemcuv2_heapstats environment, which sets JUMBO_HEAP_STATS=1 and links
+// with --wrap for malloc/calloc/realloc/free so the sketch's allocations
+// (String, new, libraries) go through the counters below. The SDK and lwIP
+// allocate through pvPortMalloc and friends, which bypass the wrapped
+// symbols: their use shows up in the free heap and fragmentation figures
+// but not in the allocation counts. When off, HEAP_STATS_UPDATE expands to
+// nothing.
+#ifndef JUMBO_HEAP_STATS
+#define JUMBO_HEAP_STATS 0
+#endif
+
+#if JUMBO_HEAP_STATS
+
+#include <Arduino.h>
+#include <stdlib.h>
+
+// How often the numbers are printed (and the per-loop figures restarted)
+#ifndef HEAP_STATS_REPORT_MS
+#define HEAP_STATS_REPORT_MS 10000
+#endif
+
+struct HeapCounters {
+  volatile uint32_t allocs; // malloc/calloc/realloc calls, all time
+  volatile uint32_t frees;
+};
+
+inline HeapCounters heapCounters = {0, 0};
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+// The linker sends every call to these here (-Wl,--wrap=...)
+void *__wrap_malloc(size_t size) {
+  heapCounters.allocs++;
+  return __real_malloc(size);
+}
+void *__wrap_calloc(size_t n, size_t size) {
+  heapCounters.allocs++;
+  return __real_calloc(n, size);
+}
+// A resize counts as a free plus an allocation
+void *__wrap_realloc(void *ptr, size_t size) {
+  heapCounters.allocs++;
+  if (ptr) {
+    heapCounters.frees++;
+  }
+  return __real_realloc(ptr, size);
+}
+void __wrap_free(void *ptr) {
+  if (ptr) {
+    heapCounters.frees++;
+  }
+  __real_free(ptr);
+}
+}
+
+class HeapStats {
+private:
+  uint32_t loopStartAllocs;
+  uint32_t windowStartAllocs;
+  uint32_t loops;
+  uint32_t maxLoopAllocs;
+  uint32_t minFreeHeap;
+  unsigned long lastReport;
+
+public:
+  HeapStats()
+      : loopStartAllocs(0), windowStartAllocs(0), loops(0), maxLoopAllocs(0),
+        minFreeHeap(UINT32_MAX), lastReport(0) {}
+
+  // Once per loop(): closes the previous loop's allocation count
+  void update(unsigned long now) {
+    uint32_t allocs = heapCounters.allocs;
+    uint32_t loopAllocs = allocs - loopStartAllocs;
+    loopStartAllocs = allocs;
+    if (loops > 0 && loopAllocs > maxLoopAllocs) {
+      maxLoopAllocs = loopAllocs;
+    }
+    loops++;
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (freeHeap < minFreeHeap) {
+      minFreeHeap = freeHeap;
+    }
+
+    if (now - lastReport >= HEAP_STATS_REPORT_MS) {
+      lastReport = now;
+      report(allocs);
+      windowStartAllocs = allocs;
+      loops = 0;
+      maxLoopAllocs = 0;
+      minFreeHeap = UINT32_MAX;
+    }
+  }
+
+  // e.g. HEAP free=31240 min=29876 block=28712 frag=7% live=143
+  //        allocs/loop avg=0.00 max=0
+  void report(uint32_t allocs) {
+    uint32_t window = allocs - windowStartAllocs;
+    uint32_t avgHundredths = loops ? window * 100 / loops : 0;
+    Serial.printf("HEAP free=%lu min=%lu block=%lu frag=%u%% live=%ld "
+                  "allocs/loop avg=%lu.%02lu max=%lu\n",
+                  (unsigned long)ESP.getFreeHeap(),
+                  (unsigned long)minFreeHeap,
+                  (unsigned long)ESP.getMaxFreeBlockSize(),
+                  (unsigned)ESP.getHeapFragmentation(),
+                  (long)(heapCounters.allocs - heapCounters.frees),
+                  (unsigned long)(avgHundredths / 100),
+                  (unsigned long)(avgHundredths % 100),
+                  (unsigned long)maxLoopAllocs);
+  }
+};
+
+inline HeapStats heapStats;
+
+#define HEAP_STATS_UPDATE(now) heapStats.update(now)
+
+#else
+
+#define HEAP_STATS_UPDATE(now)
+
+#endif
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef LOOPPROFILER_H
+#define LOOPPROFILER_H
+
+// Per-phase latency histograms for loop(). Off by default; enable with
+// #define JUMBO_PROFILE 1 in Config.h (or -D JUMBO_PROFILE=1). When off,
+// the PROFILE_* macros expand to nothing and none of this is compiled.
+#ifndef JUMBO_PROFILE
+#define JUMBO_PROFILE 0
+#endif
+
+#if JUMBO_PROFILE
+
+#include <Arduino.h>
+#if !defined(ARDUINO_ARCH_ESP8266)
+#include <chrono>
+#endif
+
+// How often the histograms are printed (and then cleared)
+#ifndef PROFILE_REPORT_MS
+#define PROFILE_REPORT_MS 10000
+#endif
+
+// Bucket i holds samples of [2^(i-1), 2^i) us; bucket 0 is under 1 us.
+// The last bucket also takes everything over ~1 s.
+#define PROFILE_BUCKETS 21
+
+enum ProfilePhase : uint8_t {
+  PROF_LOOP,            // One whole loop() iteration
+  PROF_API_UPDATE,      // APIClient::update
+  PROF_CONTROLLER,      // JumboController::update
+  PROF_EYE_UPDATE,      // Eye::update (inside PROF_CONTROLLER)
+  PROF_EYE_DRAW,        // Eye::draw
+  PROF_TEXT_DRAW,       // TextBox::draw
+  PROF_SEND_BUFFER,     // FrameFlusher::flush (sendBuffer / area updates)
+  PROF_PHASE_COUNT
+};
+
+class LoopProfiler {
+private:
+  struct Histogram {
+    uint32_t count;
+    uint32_t maxUs;
+    uint32_t buckets[PROFILE_BUCKETS];
+  };
+
+  Histogram phases[PROF_PHASE_COUNT];
+  uint32_t cyclesPerUs;
+  unsigned long lastReport;
+
+  static const char *phaseName(uint8_t p) {
+    static const char *names[PROF_PHASE_COUNT] = {
+        "loop", "api_update", "controller", "eye_update",
+        "eye_draw", "text_draw", "send_buffer"};
+    return names[p];
+  }
+
+  static uint8_t bucketOf(uint32_t us) {
+    uint8_t b = 0;
+    while (us && b < PROFILE_BUCKETS - 1) {
+      us >>= 1;
+      b++;
+    }
+    return b;
+  }
+
+  // Upper bound (us) of the bucket holding the given share of samples
+  static uint32_t percentile(const Histogram &h, uint32_t perMille) {
+    uint32_t target = (h.count * perMille + 999) / 1000;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < PROFILE_BUCKETS; b++) {
+      seen += h.buckets[b];
+      if (seen >= target) {
+        uint32_t bound = 1UL << b;
+        return bound < h.maxUs ? bound : h.maxUs;
+      }
+    }
+    return h.maxUs;
+  }
+
+public:
+  LoopProfiler() : cyclesPerUs(0), lastReport(0) { clear(); }
+
+  static uint32_t cycles() {
+#if defined(ARDUINO_ARCH_ESP8266)
+    return ESP.getCycleCount();
+#else
+    // Host builds: nanoseconds stand in for cycles (see record())
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  void record(uint8_t phase, uint32_t elapsedCycles) {
+    if (cyclesPerUs == 0) {
+#if defined(ARDUINO_ARCH_ESP8266)
+      cyclesPerUs = ESP.getCpuFreqMHz();
+#else
+      cyclesPerUs = 1000;
+#endif
+    }
+    uint32_t us = elapsedCycles / cyclesPerUs;
+    Histogram &h = phases[phase];
+    h.count++;
+    h.buckets[bucketOf(us)]++;
+    if (us > h.maxUs) {
+      h.maxUs = us;
+    }
+  }
+
+  void clear() {
+    memset(phases, 0, sizeof(phases));
+  }
+
+  // One line per phase that ran, e.g.
+  //   PROF eye_draw n=1502 p50=64us p99=128us max=141us
+  void report() {
+    for (uint8_t p = 0; p < PROF_PHASE_COUNT; p++) {
+      const Histogram &h = phases[p];
+      if (h.count == 0) {
+        continue;
+      }
+      Serial.printf("PROF %s n=%lu p50=%luus p99=%luus max=%luus\n",
+                    phaseName(p), (unsigned long)h.count,
+                    (unsigned long)percentile(h, 500),
+                    (unsigned long)percentile(h, 990),
+                    (unsigned long)h.maxUs);
+    }
+  }
+
+  // Print and start a fresh window every PROFILE_REPORT_MS
+  void update(unsigned long now) {
+    if (now - lastReport >= PROFILE_REPORT_MS) {
+      lastReport = now;
+      report();
+      clear();
+    }
+  }
+
+  uint32_t getCount(uint8_t phase) const { return phases[phase].count; }
+  uint32_t getMaxUs(uint8_t phase) const { return phases[phase].maxUs; }
+};
+
+inline LoopProfiler loopProfiler;
+
+// Times the rest of the enclosing block
+class ProfileScope {
+private:
+  uint8_t phase;
+  uint32_t start;
+
+public:
+  ProfileScope(uint8_t _phase)
+      : phase(_phase), start(LoopProfiler::cycles()) {}
+  ~ProfileScope() {
+    loopProfiler.record(phase, LoopProfiler::cycles() - start);
+  }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase)                                                   \
+  ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define PROFILE_REPORT(now) loopProfiler.update(now)
+
+#else
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE_REPORT(now)
+
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef DISPLAYBACKEND_H
+#define DISPLAYBACKEND_H
+
+#include <U8g2lib.h>
+
+// U8g2 buffer for the SSD1306:
+//   0 - full frame buffer (_F_): 1 KB, drawn once per frame, and only the
+//       changed tiles are sent (FrameFlusher keeps a 1 KB copy of the panel)
+//   1 - page buffer of one page (_1_): 128 bytes
+//   2 - page buffer of two pages (_2_): 256 bytes
+// In page mode the frame is drawn once per buffer-sized band (8 or 4 times)
+// and only bands that changed are sent. That is slower, but saves about
+// 1.9 KB (1.7 KB with 2 pages) of RAM for TLS and the like.
+#ifndef DISPLAY_BUFFER_PAGES
+#define DISPLAY_BUFFER_PAGES 0
+#endif
+
+#if DISPLAY_BUFFER_PAGES == 1
+typedef U8G2_SSD1306_128X64_NONAME_1_HW_I2C DisplayDriver;
+#elif DISPLAY_BUFFER_PAGES == 2
+typedef U8G2_SSD1306_128X64_NONAME_2_HW_I2C DisplayDriver;
+#else
+typedef U8G2_SSD1306_128X64_NONAME_F_HW_I2C DisplayDriver;
+#endif
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef FRAMEFLUSHER_H
+#define FRAMEFLUSHER_H
+
+#include "../Debug/LoopProfiler.h"
+#include "DisplayBackend.h"
+#include <U8g2lib.h>
+#include <string.h>
+
+// Size of a full SSD1306 128x64 frame (8 pages x 128 columns)
+#define FRAME_BUFFER_BYTES 1024
+#define FRAME_PAGES 8
+
+// If more than this share of tiles changed, one full sendBuffer() is cheaper
+// than many small updateDisplayArea() transactions.
+#define FULL_FLUSH_TILE_PERCENT 75
+
+// Sends only the parts of the U8g2 frame buffer that changed since the last
+// flush. With a full buffer, the buffer is compared against a copy of what
+// the panel currently shows, one 8x8 tile (8 bytes) at a time, and each
+// page (row of tiles) is sent as a single run from its first to its last
+// changed tile.
+//
+// Page buffers (and full buffers in DISPLAY_BUFFER_PAGES builds, which drop
+// the 1 KB copy) are compared by a hash per page instead, and whole pages
+// are sent.
+class FrameFlusher {
+private:
+#if DISPLAY_BUFFER_PAGES == 0
+  uint8_t shownFrame[FRAME_BUFFER_BYTES]; // What the panel currently displays
+#endif
+  uint32_t shownPageHash[FRAME_PAGES]; // FNV-1a of each page on the panel
+  bool fullInvalidate;
+
+  // Stats for the last flush (or frame, in page mode), for benchmarks/logs
+  int lastTilesSent;
+
+  static uint32_t pageHash(const uint8_t *page, int bytes) {
+    uint32_t h = 2166136261UL;
+    for (int i = 0; i < bytes; i++) {
+      h = (h ^ page[i]) * 16777619UL;
+    }
+    return h;
+  }
+
+  static bool tileChanged(const uint8_t *a, const uint8_t *b) {
+    return memcmp(a, b, 8) != 0;
+  }
+
+#if DISPLAY_BUFFER_PAGES == 0
+  int sendFull(U8G2 &u8g2, uint8_t *buf, int frameBytes) {
+    u8g2.sendBuffer();
+    memcpy(shownFrame, buf, frameBytes);
+    fullInvalidate = false;
+    return frameBytes / 8;
+  }
+
+  int flushTiles(U8G2 &u8g2) {
+    uint8_t *buf = u8g2.getBufferPtr();
+    int tilesW = u8g2.getBufferTileWidth();
+    int tilesH = u8g2.getBufferTileHeight();
+    int frameBytes = tilesW * tilesH * 8;
+
+    // Unknown geometry: we can't shadow it, so always send everything
+    if (frameBytes > FRAME_BUFFER_BYTES) {
+      u8g2.sendBuffer();
+      return tilesW * tilesH;
+    }
+
+    if (fullInvalidate) {
+      return sendFull(u8g2, buf, frameBytes);
+    }
+
+    // 1. Find the dirty span of every page
+    uint8_t firstDirty[FRAME_PAGES];
+    uint8_t lastDirty[FRAME_PAGES];
+    int dirtyTiles = 0;
+
+    for (int ty = 0; ty < tilesH && ty < FRAME_PAGES; ty++) {
+      firstDirty[ty] = 0xFF;
+      lastDirty[ty] = 0;
+      int rowOffset = ty * tilesW * 8;
+      for (int tx = 0; tx < tilesW; tx++) {
+        int offset = rowOffset + tx * 8;
+        if (tileChanged(buf + offset, shownFrame + offset)) {
+          if (firstDirty[ty] == 0xFF)
+            firstDirty[ty] = tx;
+          lastDirty[ty] = tx;
+        }
+      }
+      if (firstDirty[ty] != 0xFF)
+        dirtyTiles += lastDirty[ty] - firstDirty[ty] + 1;
+    }
+
+    if (dirtyTiles == 0) {
+      return 0;
+    }
+
+    // 2. Mostly changed: a single full transfer wins
+    if (dirtyTiles * 100 > tilesW * tilesH * FULL_FLUSH_TILE_PERCENT) {
+      return sendFull(u8g2, buf, frameBytes);
+    }
+
+    // 3. Send each dirty run and record it as shown
+    for (int ty = 0; ty < tilesH && ty < FRAME_PAGES; ty++) {
+      if (firstDirty[ty] == 0xFF)
+        continue;
+      int tw = lastDirty[ty] - firstDirty[ty] + 1;
+      u8g2.updateDisplayArea(firstDirty[ty], ty, tw, 1);
+
+      int offset = ty * tilesW * 8 + firstDirty[ty] * 8;
+      memcpy(shownFrame + offset, buf + offset, tw * 8);
+    }
+
+    return dirtyTiles;
+  }
+#endif
+
+  // Page granularity: hash each page the buffer holds against what was
+  // last sent to it. A page buffer is sent as a whole if any of its pages
+  // changed; a full buffer sends just the changed pages.
+  int flushPages(U8G2 &u8g2, bool paged) {
+    const uint8_t *buf = u8g2.getBufferPtr();
+    int pageBytes = u8g2.getBufferTileWidth() * 8;
+    int firstPage = paged ? u8g2.getBufferCurrTileRow() : 0;
+    int pages = u8g2.getBufferTileHeight();
+    bool changed[FRAME_PAGES];
+    int changedPages = 0;
+
+    for (int p = 0; p < pages && firstPage + p < FRAME_PAGES; p++) {
+      uint32_t h = pageHash(buf + p * pageBytes, pageBytes);
+      changed[p] = fullInvalidate || h != shownPageHash[firstPage + p];
+      if (changed[p]) {
+        shownPageHash[firstPage + p] = h;
+        changedPages++;
+      }
+    }
+
+    if (changedPages == 0) {
+      return 0;
+    }
+    if (paged || changedPages == pages) {
+      u8g2.sendBuffer();
+      return pages * u8g2.getBufferTileWidth();
+    }
+    for (int p = 0; p < pages && p < FRAME_PAGES; p++) {
+      if (changed[p]) {
+        u8g2.updateDisplayArea(0, p, u8g2.getBufferTileWidth(), 1);
+      }
+    }
+    return changedPages * u8g2.getBufferTileWidth();
+  }
+
+public:
+  FrameFlusher() : fullInvalidate(true), lastTilesSent(0) {
+    memset(shownPageHash, 0, sizeof(shownPageHash));
+  }
+
+  // True if the display's buffer holds only some of the pages (_1_/_2_),
+  // so a frame takes one draw + flush pass per band (see JumboController)
+  static bool isPaged(U8G2 &u8g2) {
+    return u8g2.getBufferTileHeight() < u8g2.getDisplayHeight() / 8;
+  }
+
+  // RAM this flusher keeps about the panel, for comparing backends
+  static int shadowBytes(U8G2 &u8g2) {
+#if DISPLAY_BUFFER_PAGES == 0
+    if (!isPaged(u8g2)) {
+      return FRAME_BUFFER_BYTES + sizeof(shownPageHash);
+    }
+#else
+    (void)u8g2; // Always a page buffer
+#endif
+    return sizeof(shownPageHash);
+  }
+
+  // Next flush sends the whole frame (after begin, power save, etc.)
+  void invalidate() { fullInvalidate = true; }
+
+  int getLastTilesSent() const { return lastTilesSent; }
+
+  // Call instead of u8g2.sendBuffer(): once per frame with a full buffer,
+  // once per band in page mode. Returns the number of tiles sent.
+  int flush(U8G2 &u8g2) {
+    PROFILE_SCOPE(PROF_SEND_BUFFER);
+    bool paged = isPaged(u8g2);
+    int tiles;
+#if DISPLAY_BUFFER_PAGES == 0
+    if (!paged) {
+      tiles = flushTiles(u8g2);
+      fullInvalidate = false;
+      return lastTilesSent = tiles;
+    }
+#endif
+    tiles = flushPages(u8g2, paged);
+
+    // Page mode: count the whole frame, and keep invalidating until the
+    // last band has been sent
+    int firstPage = paged ? u8g2.getBufferCurrTileRow() : 0;
+    bool lastBand = firstPage + u8g2.getBufferTileHeight() >= FRAME_PAGES;
+    lastTilesSent = firstPage == 0 ? tiles : lastTilesSent + tiles;
+    if (lastBand) {
+      fullInvalidate = false;
+    }
+    return tiles;
+  }
+};
+
+#endif
@@ -1,10 +1,32 @@
 #ifndef EYE_H
 #define EYE_H
 
+#include "../Debug/LoopProfiler.h"
+#include "../Math/FixedPoint.h"
 #include "../Shapes.h"
+#include "EyeSpriteCache.h"
 #include <Arduino.h>
 #include <math.h>
 
+// Set to 1 to animate eyelids, bounce and look-at with Q8.8 integers
+// instead of software floats (the ESP8266 has no FPU).
+#ifndef EYE_FIXED_POINT
+#define EYE_FIXED_POINT 0
+#endif
+
+#if EYE_FIXED_POINT
+typedef fix8_t EyeScalar;
+#define EYE_PARAM(v) fix8FromFloat(v)
+#define EYE_ONE FIX8_ONE
+#else
+typedef float EyeScalar;
+#define EYE_PARAM(v) (v)
+#define EYE_ONE 1.0f
+#endif
+
+// sin(ms / 50.0) as a binary angle: 256 / (2 * PI * 50) in Q16.16
+#define BOUNCE_ANGLE_MULTIPLIER 53404
+
 class Eye : public Shape {
 public:
   int radius;
@@ -22,13 +44,30 @@ public:
     EXPR_CALM,
     EXPR_SLEEP
   };
+  static const int EXPRESSION_COUNT = 6;
+
+  // API name to expression, case-insensitive. Unknown names are angry.
+  static Expression expressionFromName(const char *name) {
+    static const char *const names[EXPRESSION_COUNT] = {
+        "angry", "happy", "shocked", "sad", "calm", "sleep"};
+    for (int i = 0; i < EXPRESSION_COUNT; i++) {
+      if (name && strcasecmp(name, names[i]) == 0)
+        return (Expression)i;
+    }
+    return EXPR_ANGRY;
+  }
+
+  // Wire value (enum order) to expression. Unknown values are angry.
+  static Expression expressionFromId(uint8_t id) {
+    return id < EXPRESSION_COUNT ? (Expression)id : EXPR_ANGRY;
+  }
 
   struct EyelidParams {
-    float topOuterOffset; // Factor of radius: -1.0 (top) to 1.0 (bottom)
-    float topInnerOffset;
-    float bottomOuterOffset;
-    float bottomInnerOffset;
-    float pupilScale; // 1.0 = normal, <1.0 = constrict, >1.0 = dilate
+    EyeScalar topOuterOffset; // Factor of radius: -1.0 (top) to 1.0 (bottom)
+    EyeScalar topInnerOffset;
+    EyeScalar bottomOuterOffset;
+    EyeScalar bottomInnerOffset;
+    EyeScalar pupilScale; // 1.0 = normal, <1.0 = constrict, >1.0 = dilate
   };
 
   EyeState state;
@@ -42,94 +81,144 @@ public:
   int animDuration;
   bool isAnimating;
 
-  float blinkPercent; // 0.0 (open) to 1.0 (closed)
+  EyeScalar blinkPercent; // 0 (open) to EYE_ONE (closed)
   unsigned long lastStateChangeTime;
   int closeDuration; // ms
   int openDuration;  // ms
   int closedPause;   // ms
 
+  int bounceY; // Laughter jiggle offset, advanced in update()
+  bool dirty;  // Visual state changed since the last draw
+
+  // Optional pre-rendered expressions (see buildSprites)
+  EyeSpriteCache *sprites;
+
   Eye(int _x, int _y, int _r, bool _isLeft)
       : Shape(_x, _y), radius(_r), isLeft(_isLeft), state(STATE_IDLE),
-        animDuration(500), isAnimating(false), blinkPercent(0.0),
-        closeDuration(80), openDuration(80), closedPause(50) {
+        animDuration(500), isAnimating(false), blinkPercent(0),
+        closeDuration(80), openDuration(80), closedPause(50), bounceY(0),
+        dirty(true), sprites(nullptr) {
 
     // Default pupil size and position
     pupilRadius = _r / 1.6;
     pupilOffsetX = 0;
     pupilOffsetY = 0;
 
-    // Initial Expression: ANGRY
+    // Initial Expression: ANGRY (the morph starts from it too)
+    currentParams = getParamsForExpression(EXPR_ANGRY);
     setExpression(EXPR_ANGRY, 0);
   }
 
+#if EYE_FIXED_POINT
+  static EyeScalar lerp(EyeScalar a, EyeScalar b, fix8_t t) {
+    return fix8Lerp(a, b, t);
+  }
+
+  // value * factor, truncated toward zero
+  static int scaled(int value, EyeScalar factor) {
+    return fix8ToInt(value * factor);
+  }
+
+  // Screen row of a lid edge: centerY + radius * offset, truncated
+  int lidY(int centerY, EyeScalar offset) const {
+    return fix8ToInt(centerY * FIX8_ONE + radius * offset);
+  }
+
+  // elapsed / duration, capped at 1.0 (clamped before the shift, which
+  // would overflow past 2^24 ms)
+  static EyeScalar fraction(unsigned long elapsed, int duration) {
+    unsigned long span = duration > 0 ? duration : 1;
+    if (elapsed > span) {
+      elapsed = span;
+    }
+    return (EyeScalar)((elapsed << FIX8_SHIFT) / span);
+  }
+#else
+  static EyeScalar lerp(EyeScalar a, EyeScalar b, float t) {
+    return a + (b - a) * t;
+  }
+
+  static int scaled(int value, EyeScalar factor) {
+    return (int)(value * factor);
+  }
+
+  int lidY(int centerY, EyeScalar offset) const {
+    return centerY + (radius * offset);
+  }
+
+  static EyeScalar fraction(unsigned long elapsed, int duration) {
+    return (float)elapsed / duration;
+  }
+#endif
+
   // Define the target shapes for each expression
   EyelidParams getParamsForExpression(Expression e) {
     EyelidParams p;
     // Default scale
-    p.pupilScale = 1.0;
+    p.pupilScale = EYE_PARAM(1.0);
 
     if (e == EXPR_ANGRY) {
       // Top lid slants down inwards
-      p.topOuterOffset = -0.8; // High up
-      p.topInnerOffset = 0.2;  // Low down
+      p.topOuterOffset = EYE_PARAM(-0.8); // High up
+      p.topInnerOffset = EYE_PARAM(0.2);  // Low down
       // Bottom lid open (pushed down)
-      p.bottomOuterOffset = 1.2;
-      p.bottomInnerOffset = 1.2;
+      p.bottomOuterOffset = EYE_PARAM(1.2);
+      p.bottomInnerOffset = EYE_PARAM(1.2);
     } else if (e == EXPR_HAPPY) {
       // "Laughter": Squinted from bottom up, top slightly down
       // Crescent shape pointing up
-      p.topOuterOffset = -0.5;
-      p.topInnerOffset = -0.5; // Top lid slightly relaxed/flat
+      p.topOuterOffset = EYE_PARAM(-0.5);
+      p.topInnerOffset = EYE_PARAM(-0.5); // Top lid slightly relaxed/flat
 
-      p.bottomOuterOffset = 0.1; // Cheek pushed up high
-      p.bottomInnerOffset = 0.1;
+      p.bottomOuterOffset = EYE_PARAM(0.1); // Cheek pushed up high
+      p.bottomInnerOffset = EYE_PARAM(0.1);
     } else if (e == EXPR_SHOCKED) {
       // SHOCKED: Wide open eyes, small pupils
       // Lids pulled way back
-      p.topOuterOffset = -1.2;
-      p.topInnerOffset = -1.2;
+      p.topOuterOffset = EYE_PARAM(-1.2);
+      p.topInnerOffset = EYE_PARAM(-1.2);
 
-      p.bottomOuterOffset = 1.2;
-      p.bottomInnerOffset = 1.2;
+      p.bottomOuterOffset = EYE_PARAM(1.2);
+      p.bottomInnerOffset = EYE_PARAM(1.2);
 
-      p.pupilScale = 0.5; // Constricted pupil
+      p.pupilScale = EYE_PARAM(0.5); // Constricted pupil
     } else if (e == EXPR_SAD) {
       // SAD: Puppy dog eyes
       // Outer corners droop down significantly
       // Inner corners go UP slightly or stay high
 
-      p.topOuterOffset = 0.5;  // Droop down outer
-      p.topInnerOffset = -0.8; // High inner (brows go up in middle)
+      p.topOuterOffset = EYE_PARAM(0.5);  // Droop down outer
+      p.topInnerOffset = EYE_PARAM(-0.8); // High inner (brows go up in middle)
 
-      p.bottomOuterOffset = 0.5; // Droop down outer
-      p.bottomInnerOffset = 0.8; // Lower inner
+      p.bottomOuterOffset = EYE_PARAM(0.5); // Droop down outer
+      p.bottomInnerOffset = EYE_PARAM(0.8); // Lower inner
 
-      p.pupilScale = 1.0;
+      p.pupilScale = EYE_PARAM(1.0);
     } else if (e == EXPR_CALM) {
       // CALM / SATISFIED
       // Relaxed eyelids. Not sleepy, but peaceful.
       // Top lid lowers slightly more than neutral
-      p.topOuterOffset = -0.1;
-      p.topInnerOffset = -0.1;
+      p.topOuterOffset = EYE_PARAM(-0.1);
+      p.topInnerOffset = EYE_PARAM(-0.1);
 
       // Bottom lid relaxed (pushed down)
-      p.bottomOuterOffset = 0.8;
-      p.bottomInnerOffset = 0.8;
+      p.bottomOuterOffset = EYE_PARAM(0.8);
+      p.bottomInnerOffset = EYE_PARAM(0.8);
 
-      p.pupilScale = 1.0;
+      p.pupilScale = EYE_PARAM(1.0);
     } else if (e == EXPR_SLEEP) {
       // SLEEP: Eyes closed
-      p.topOuterOffset = 0.8; // Fully down
-      p.topInnerOffset = 0.8;
-      p.bottomOuterOffset =
-          0.8; // Lower lid meets it (or stays down if top comes all way)
+      p.topOuterOffset = EYE_PARAM(0.8); // Fully down
+      p.topInnerOffset = EYE_PARAM(0.8);
+      // Lower lid meets it (or stays down if top comes all way)
+      p.bottomOuterOffset = EYE_PARAM(0.8);
       // If top goes to 0.8 (near bottom), and bottom is 0.8, they meet?
       // Let's set top to 1.0 (bottom edge) and bottom to 1.0.
-      p.topOuterOffset = 1.0;
-      p.topInnerOffset = 1.0;
-      p.bottomOuterOffset = 1.0;
-      p.bottomInnerOffset = 1.0;
-      p.pupilScale = 1.0;
+      p.topOuterOffset = EYE_PARAM(1.0);
+      p.topInnerOffset = EYE_PARAM(1.0);
+      p.bottomOuterOffset = EYE_PARAM(1.0);
+      p.bottomInnerOffset = EYE_PARAM(1.0);
+      p.pupilScale = EYE_PARAM(1.0);
     }
     return p;
   }
@@ -141,6 +230,7 @@ public:
     animStartTime = millis();
     animDuration = duration;
     isAnimating = true;
+    dirty = true;
 
     // If duration is 0, snap immediately
     if (duration == 0) {
@@ -153,59 +243,95 @@ public:
     if (state == STATE_IDLE) {
       state = STATE_CLOSING;
       lastStateChangeTime = millis();
+      dirty = true;
     }
   }
 
   void update() {
+    PROFILE_SCOPE(PROF_EYE_UPDATE);
     unsigned long now = millis();
 
+    // Anything in motion changes the picture this frame
+    if (isAnimating || (state != STATE_IDLE && currentExpr != EXPR_SLEEP)) {
+      dirty = true;
+    }
+
+    // Animation: Laughter Jiggle
+    // Fast subtle bounce of the whole eye while Happy
+    int newBounceY = 0;
+    if (currentExpr == EXPR_HAPPY && !isAnimating) {
+#if EYE_FIXED_POINT
+      // Q1.14 sine * 1.5, truncated like the float cast
+      newBounceY =
+          (sinLutQ14(msToBinaryAngle(now, BOUNCE_ANGLE_MULTIPLIER)) * 3) /
+          (2 << 14);
+#else
+      newBounceY = (sin(now / 50.0) * 1.5); // +/- 1 pixel
+#endif
+    }
+    if (newBounceY != bounceY) {
+      bounceY = newBounceY;
+      dirty = true;
+    }
+
     // 1. Handle Expression Morphing
     if (isAnimating) {
+#if EYE_FIXED_POINT
+      // Clamp before shifting: after 2^24 ms (e.g. a long standby) the
+      // shifted time would wrap and restart the morph
+      unsigned long span = animDuration > 0 ? animDuration : 1;
+      unsigned long elapsed = now - animStartTime;
+      if (elapsed > span) {
+        elapsed = span;
+      }
+      fix8_t t = (fix8_t)((elapsed << FIX8_SHIFT) / span);
+      if (t >= FIX8_ONE) {
+#else
       float t = (float)(now - animStartTime) / animDuration;
       if (t >= 1.0) {
-        t = 1.0;
+#endif
+        // Land exactly on the target so the settled frame matches the
+        // pre-rendered sprite
         isAnimating = false;
         currentParams = targetParams;
+      } else {
+        // Lerp parameters
+        // A simple linear interpolation for each param
+        currentParams.topOuterOffset =
+            lerp(startParams.topOuterOffset, targetParams.topOuterOffset, t);
+        currentParams.topInnerOffset =
+            lerp(startParams.topInnerOffset, targetParams.topInnerOffset, t);
+        currentParams.bottomOuterOffset = lerp(
+            startParams.bottomOuterOffset, targetParams.bottomOuterOffset, t);
+        currentParams.bottomInnerOffset = lerp(
+            startParams.bottomInnerOffset, targetParams.bottomInnerOffset, t);
+
+        // Lerp Pupil Scale
+        currentParams.pupilScale =
+            lerp(startParams.pupilScale, targetParams.pupilScale, t);
       }
-
-      // Lerp parameters
-      // A simple linear interpolation for each float
-      currentParams.topOuterOffset =
-          startParams.topOuterOffset +
-          (targetParams.topOuterOffset - startParams.topOuterOffset) * t;
-      currentParams.topInnerOffset =
-          startParams.topInnerOffset +
-          (targetParams.topInnerOffset - startParams.topInnerOffset) * t;
-      currentParams.bottomOuterOffset =
-          startParams.bottomOuterOffset +
-          (targetParams.bottomOuterOffset - startParams.bottomOuterOffset) * t;
-      currentParams.bottomInnerOffset =
-          startParams.bottomInnerOffset +
-          (targetParams.bottomInnerOffset - startParams.bottomInnerOffset) * t;
-
-      // Lerp Pupil Scale
-      currentParams.pupilScale =
-          startParams.pupilScale +
-          (targetParams.pupilScale - startParams.pupilScale) * t;
     }
 
     // Force closed if SLEEP
     if (currentExpr == EXPR_SLEEP) {
+      if (blinkPercent != EYE_ONE) {
+        dirty = true;
+      }
       state = STATE_CLOSED;
-      blinkPercent = 1.0;
+      blinkPercent = EYE_ONE;
       return; // Skip normal blink state machine
     }
 
     // 2. Handle Blinking
     switch (state) {
     case STATE_IDLE:
-      blinkPercent = 0.0;
+      blinkPercent = 0;
       break;
 
     case STATE_CLOSING: {
-      float progress = (float)(now - lastStateChangeTime) / closeDuration;
-      if (progress >= 1.0) {
-        progress = 1.0;
+      EyeScalar progress = fraction(now - lastStateChangeTime, closeDuration);
+      if (progress >= EYE_ONE) {
+        progress = EYE_ONE;
         state = STATE_CLOSED;
         lastStateChangeTime = now;
       }
@@ -214,7 +340,7 @@ public:
     }
 
     case STATE_CLOSED:
-      blinkPercent = 1.0;
+      blinkPercent = EYE_ONE;
       if (now - lastStateChangeTime >= (unsigned long)closedPause) {
         state = STATE_OPENING;
         lastStateChangeTime = now;
@@ -222,12 +348,12 @@ public:
       break;
 
     case STATE_OPENING: {
-      float progress = (float)(now - lastStateChangeTime) / openDuration;
-      if (progress >= 1.0) {
-        progress = 1.0;
+      EyeScalar progress = fraction(now - lastStateChangeTime, openDuration);
+      if (progress >= EYE_ONE) {
+        progress = EYE_ONE;
         state = STATE_IDLE;
       }
-      blinkPercent = 1.0 - progress;
+      blinkPercent = EYE_ONE - progress;
       break;
     }
     }
@@ -237,30 +363,100 @@ public:
     // Simple look logic: constrain pupil within the eye
     int dx = targetX - x;
     int dy = targetY - y;
-    float dist = sqrt(dx * dx + dy * dy);
     int maxDist = radius - pupilRadius - 2;
 
+#if EYE_FIXED_POINT
+    uint32_t distSq = (uint32_t)(dx * dx + dy * dy);
+    if (maxDist >= 0 && distSq > (uint32_t)(maxDist * maxDist)) {
+      int dist = isqrt32(distSq);
+      pupilOffsetX = dx * maxDist / dist;
+      pupilOffsetY = dy * maxDist / dist;
+    } else {
+#else
+    float dist = sqrt(dx * dx + dy * dy);
+
     if (dist > maxDist && dist > 0) {
       float ratio = maxDist / dist;
       pupilOffsetX = dx * ratio;
       pupilOffsetY = dy * ratio;
     } else {
+#endif
       pupilOffsetX = dx;
       pupilOffsetY = dy;
     }
+    dirty = true;
+  }
+
+  // Render every expression once into the cache and use it from then on.
+  // Clobbers the U8g2 buffer, so call before the first frame (e.g. begin()).
+  // With a page buffer each expression is rendered once per band.
+  void buildSprites(U8G2 &u8g2, EyeSpriteCache &cache) {
+    sprites = nullptr;
+    if (!cache.fits(radius) || 2 * radius + 1 > u8g2.getDisplayHeight())
+      return;
+
+    // Save the live state we are about to borrow
+    int savedX = x, savedY = y, savedBounce = bounceY;
+    int savedPupilX = pupilOffsetX, savedPupilY = pupilOffsetY;
+    EyeScalar savedBlink = blinkPercent;
+    EyelidParams savedParams = currentParams;
+
+    // Open eye, centred so the sprite's top-left lands on (0, 0)
+    x = radius;
+    y = radius;
+    bounceY = 0;
+    pupilOffsetX = 0;
+    pupilOffsetY = 0;
+    blinkPercent = 0;
+
+    int spritePages = (2 * radius + 8) / 8;
+    int band = u8g2.getBufferTileHeight();
+    bool paged = band < u8g2.getDisplayHeight() / 8;
+
+    for (int e = 0; e < EXPRESSION_COUNT; e++) {
+      currentParams = getParamsForExpression((Expression)e);
+      for (int page = 0; page < spritePages; page += band) {
+        if (paged) {
+          u8g2.setBufferCurrTileRow(page);
+        }
+        u8g2.clearBuffer();
+        drawLive(u8g2);
+        cache.capture(u8g2, e, radius);
+      }
+    }
+    if (paged) {
+      u8g2.setBufferCurrTileRow(0);
+    }
+    u8g2.clearBuffer();
+
+    x = savedX;
+    y = savedY;
+    bounceY = savedBounce;
+    pupilOffsetX = savedPupilX;
+    pupilOffsetY = savedPupilY;
+    blinkPercent = savedBlink;
+    currentParams = savedParams;
+
+    sprites = &cache;
+    dirty = true;
   }
 
   void draw(U8G2 &u8g2) override {
-    // Animation: Laughter Jiggle
-    // If Happy, add a subtle random Y offset to the whole eye or pupil?
-    // "create a laughter expression... clearly show the laughter animation"
-    // Let's bounce the whole eye content slightly up and down
-    int bounceY = 0;
-    if (currentExpr == EXPR_HAPPY && !isAnimating) {
-      // Fast subtle bounce
-      bounceY = (sin(millis() / 50.0) * 1.5); // +/- 1 or 2 pixels
+    PROFILE_SCOPE(PROF_EYE_DRAW);
+    // Settled on an expression with a centred pupil: blit the cached image.
+    // Mid-morph or looking around still needs live rasterization.
+    if (sprites && !isAnimating && pupilOffsetX == 0 && pupilOffsetY == 0 &&
+        sprites->has(currentExpr)) {
+      int drawY = y + bounceY;
+      sprites->blit(u8g2, currentExpr, x - radius, drawY - radius);
+      drawBlinkLid(u8g2, x, drawY);
+      return;
     }
+    drawLive(u8g2);
+  }
 
+  void drawLive(U8G2 &u8g2) {
+    // bounceY is the laughter jiggle computed in update()
     int drawX = x;
     int drawY = y + bounceY;
 
@@ -269,10 +465,10 @@ public:
     u8g2.drawDisc(drawX, drawY, radius);
 
     // 2. Draw the Pupil
-    if (blinkPercent < 1.0) {
+    if (blinkPercent < EYE_ONE) {
       u8g2.setDrawColor(0);
       // Use the current interpolated pupil scale
-      int currentPupilRadius = (int)(pupilRadius * currentParams.pupilScale);
+      int currentPupilRadius = scaled(pupilRadius, currentParams.pupilScale);
       u8g2.drawDisc(drawX + pupilOffsetX, drawY + pupilOffsetY,
                     currentPupilRadius);
     }
@@ -284,10 +480,10 @@ public:
     // Left Eye: Inner is Right side, Outer is Left side.
     // Right Eye: Inner is Left side, Outer is Right side.
 
-    int tOuterY = drawY + (radius * currentParams.topOuterOffset);
-    int tInnerY = drawY + (radius * currentParams.topInnerOffset);
-    int bOuterY = drawY + (radius * currentParams.bottomOuterOffset);
-    int bInnerY = drawY + (radius * currentParams.bottomInnerOffset);
+    int tOuterY = lidY(drawY, currentParams.topOuterOffset);
+    int tInnerY = lidY(drawY, currentParams.topInnerOffset);
+    int bOuterY = lidY(drawY, currentParams.bottomOuterOffset);
+    int bInnerY = lidY(drawY, currentParams.bottomInnerOffset);
 
     int outerX, innerX;
 
@@ -314,9 +510,15 @@ public:
     u8g2.drawTriangle(outerX, maskBottomY, innerX, bInnerY, outerX, bOuterY);
 
     // 4. Draw Blink Eyelid (Box)
-    if (blinkPercent > 0.0) {
+    drawBlinkLid(u8g2, drawX, drawY);
+  }
+
+  void drawBlinkLid(U8G2 &u8g2, int drawX, int drawY) {
+    // A fully closed lid also hides the pupil, so this is all a blink
+    // needs on top of an open-eye sprite.
+    if (blinkPercent > 0) {
       u8g2.setDrawColor(0);
-      int boxHeight = (2 * radius) * blinkPercent;
+      int boxHeight = scaled(2 * radius, blinkPercent);
       int boxTop = drawY - radius;
       int boxWidth = (2 * radius) + 4;
       u8g2.drawBox(drawX - radius - 2, boxTop, boxWidth, boxHeight);
@@ -0,0 +1,131 @@
+#ifndef EYESPRITECACHE_H
+#define EYESPRITECACHE_H
+
+#include <U8g2lib.h>
+#include <string.h>
+
+// Set to 0 to drop the caches (saves ~1.5 KB RAM per eye)
+#ifndef EYE_SPRITE_CACHE
+#define EYE_SPRITE_CACHE 1
+#endif
+
+// Largest eye radius the cache can hold
+#ifndef EYE_SPRITE_MAX_RADIUS
+#define EYE_SPRITE_MAX_RADIUS 20
+#endif
+
+// Counts the bytes blit() writes; only the host U8g2 stand-in defines it
+#ifndef U8G2_COUNT_BUFFER_WRITES
+#define U8G2_COUNT_BUFFER_WRITES(u8g2, n)
+#endif
+
+#define EYE_SPRITE_SLOTS 6 // One per Eye::Expression
+#define EYE_SPRITE_MAX_SIDE (2 * EYE_SPRITE_MAX_RADIUS + 1)
+#define EYE_SPRITE_MAX_PAGES ((EYE_SPRITE_MAX_SIDE + 7) / 8)
+
+// Pre-rendered 1-bpp eye images, one per expression, stored in the same
+// vertical-byte page layout as the SSD1306 frame buffer. That lets draw()
+// OR whole bytes straight into the U8g2 buffer instead of rasterizing discs
+// and triangles every frame.
+//
+// Page buffers (_1_/_2_) hold only a band of the frame: capture() and
+// blit() work on the pages the buffer currently covers
+// (getBufferCurrTileRow), so a sprite is captured and drawn band by band.
+class EyeSpriteCache {
+private:
+  int side;  // Sprite width and height (2 * radius + 1)
+  int pages; // 8-pixel rows per sprite
+  bool valid[EYE_SPRITE_SLOTS];
+  uint8_t data[EYE_SPRITE_SLOTS][EYE_SPRITE_MAX_PAGES * EYE_SPRITE_MAX_SIDE];
+
+public:
+  EyeSpriteCache() : side(0), pages(0) { clear(); }
+
+  void clear() {
+    for (int i = 0; i < EYE_SPRITE_SLOTS; i++)
+      valid[i] = false;
+  }
+
+  bool fits(int radius) const {
+    return radius > 0 && radius <= EYE_SPRITE_MAX_RADIUS;
+  }
+
+  bool has(int slot) const {
+    return slot >= 0 && slot < EYE_SPRITE_SLOTS && valid[slot];
+  }
+
+  // Copy a side x side square, whose top-left corner is at (0, 0) of the
+  // frame, into a slot. With a page buffer, call once per band (starting
+  // with the band at page 0) until all (2 * radius + 8) / 8 pages are in.
+  void capture(U8G2 &u8g2, int slot, int radius) {
+    if (slot < 0 || slot >= EYE_SPRITE_SLOTS || !fits(radius))
+      return;
+    side = 2 * radius + 1;
+    pages = (side + 7) / 8;
+
+    const uint8_t *buf = u8g2.getBufferPtr();
+    int bufWidth = u8g2.getBufferTileWidth() * 8;
+    int bufFirst = u8g2.getBufferCurrTileRow();
+    int bufPages = u8g2.getBufferTileHeight();
+    uint8_t *sprite = data[slot];
+    if (bufFirst == 0) {
+      memset(sprite, 0, pages * side);
+    }
+
+    // Sprite rows start on a page boundary, so pages map 1:1
+    for (int p = bufFirst; p < pages && p < bufFirst + bufPages; p++) {
+      uint8_t rowMask = 0xFF;
+      int rowsLeft = side - p * 8;
+      if (rowsLeft < 8)
+        rowMask = (1 << rowsLeft) - 1;
+      for (int cx = 0; cx < side; cx++) {
+        sprite[p * side + cx] =
+            buf[(p - bufFirst) * bufWidth + cx] & rowMask;
+      }
+    }
+    valid[slot] = true;
+  }
+
+  // OR a sprite into the frame buffer with its top-left corner at (x0, y0).
+  // Pixels outside the sprite are left untouched (transparent blit).
+  void blit(U8G2 &u8g2, int slot, int x0, int y0) const {
+    if (!has(slot))
+      return;
+
+    uint8_t *buf = u8g2.getBufferPtr();
+    int bufWidth = u8g2.getBufferTileWidth() * 8;
+    int bufFirst = u8g2.getBufferCurrTileRow();
+    int bufPages = u8g2.getBufferTileHeight();
+    const uint8_t *sprite = data[slot];
+
+    // Split y0 into a page index and a bit shift (floor for negatives)
+    int pageOffset = (y0 >= 0) ? (y0 >> 3) : -((-y0 + 7) >> 3);
+    int shift = y0 - pageOffset * 8;
+
+    for (int p = 0; p < pages; p++) {
+      // Buffer pages (relative to the band) this sprite page lands on
+      int upper = pageOffset + p - bufFirst;
+      int lower = upper + 1;
+      if (lower < 0 || upper >= bufPages)
+        continue;
+      for (int cx = 0; cx < side; cx++) {
+        int x = x0 + cx;
+        if (x < 0 || x >= bufWidth)
+          continue;
+        uint8_t b = sprite[p * side + cx];
+        if (b == 0)
+          continue;
+        if (upper >= 0 && upper < bufPages) {
+          buf[upper * bufWidth + x] |= (uint8_t)(b << shift);
+          U8G2_COUNT_BUFFER_WRITES(u8g2, 1);
+        }
+        if (shift && lower >= 0 && lower < bufPages) {
+          buf[lower * bufWidth + x] |= (uint8_t)(b >> (8 - shift));
+          U8G2_COUNT_BUFFER_WRITES(u8g2, 1);
+        }
+      }
+    }
+  }
+};
+
+#endif
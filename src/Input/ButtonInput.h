@@ -0,0 +1,184 @@
+#ifndef BUTTONINPUT_H
+#define BUTTONINPUT_H
+
+#include <Arduino.h>
+
+// A new level counts only once it has held this long without another edge
+#ifndef INPUT_DEBOUNCE_MS
+#define INPUT_DEBOUNCE_MS 30
+#endif
+// A second tap released within this of the first makes a double-tap
+#ifndef INPUT_DOUBLE_TAP_MS
+#define INPUT_DOUBLE_TAP_MS 300
+#endif
+// Held at least this long: long-press (fires while still held)
+#ifndef INPUT_LONG_PRESS_MS
+#define INPUT_LONG_PRESS_MS 800
+#endif
+
+#define INPUT_EDGE_BUFFER 16 // Power of two
+#define INPUT_GESTURE_BUFFER 4
+
+// Button input for an active-low push button (e.g. the Flash button).
+//
+// A CHANGE interrupt time-stamps every edge into a single-producer /
+// single-consumer ring, so presses are not lost while loop() is busy.
+// update() drains the ring, debounces by timestamp (a level must be stable
+// for INPUT_DEBOUNCE_MS) and turns the presses into gestures, which callers
+// take with nextGesture(). Gesture timing uses the edge timestamps, so a
+// loop() that was busy for a while still sees the presses as they were.
+//
+// Only one ButtonInput can exist (the interrupt needs a static target).
+class ButtonInput {
+public:
+  enum Gesture { NONE, TAP, DOUBLE_TAP, LONG_PRESS };
+
+private:
+  struct Edge {
+    uint32_t time; // millis()
+    uint8_t level; // LOW = pressed
+  };
+
+  uint8_t pin;
+
+  // Written by the ISR (head) and by update() (tail) only
+  Edge edges[INPUT_EDGE_BUFFER];
+  volatile uint8_t edgeHead;
+  volatile uint8_t edgeTail;
+  volatile uint16_t edgesDropped;
+
+  // Last edge seen, and the debounced state it settles into
+  bool rawDown;
+  uint32_t rawTime;
+  bool pressed;
+  uint32_t pressStart;
+  bool pressUsed; // Long-press fired (or suppressed): release is not a tap
+  int taps;       // Released taps waiting for a possible second one
+  uint32_t tapDeadline;
+
+  uint8_t gestures[INPUT_GESTURE_BUFFER];
+  int gestureCount;
+
+  static ButtonInput *instance;
+
+  static void IRAM_ATTR onEdge() { instance->pushEdge(); }
+
+  void IRAM_ATTR pushEdge() {
+    uint8_t next = (edgeHead + 1) & (INPUT_EDGE_BUFFER - 1);
+    if (next == edgeTail) {
+      edgesDropped++;
+      return;
+    }
+    edges[edgeHead].time = millis();
+    edges[edgeHead].level = digitalRead(pin);
+    edgeHead = next;
+  }
+
+  void emit(Gesture g) {
+    if (gestureCount < INPUT_GESTURE_BUFFER) {
+      gestures[gestureCount++] = g;
+    }
+  }
+
+  // Take the raw level once nothing has changed it for the debounce time
+  // (`now` is the time of the next edge, or the current time). A bounce
+  // or glitch shorter than that never gets here. The change is dated to
+  // the edge that started the stable level.
+  void settle(uint32_t now) {
+    if (rawDown == pressed || now - rawTime < INPUT_DEBOUNCE_MS) {
+      return;
+    }
+    uint32_t at = rawTime;
+    pressed = rawDown;
+
+    if (pressed) {
+      pressStart = at;
+      pressUsed = false;
+    } else if (!pressUsed && at - pressStart >= INPUT_LONG_PRESS_MS) {
+      // Held long enough, but loop() was busy and update() never saw it
+      // held: both edges came out of the ring together
+      pressUsed = true;
+      taps = 0;
+      emit(LONG_PRESS);
+    } else if (!pressUsed) {
+      // A first tap whose window closed before this release (loop() was
+      // busy, so both came out of the ring together) stands on its own
+      if (taps == 1 && (int32_t)(at - tapDeadline) > 0) {
+        taps = 0;
+        emit(TAP);
+      }
+      if (++taps == 2) {
+        taps = 0;
+        emit(DOUBLE_TAP);
+      } else {
+        tapDeadline = at + INPUT_DOUBLE_TAP_MS;
+      }
+    }
+  }
+
+public:
+  ButtonInput(uint8_t _pin)
+      : pin(_pin), edgeHead(0), edgeTail(0), edgesDropped(0),
+        rawDown(false), rawTime(0), pressed(false), pressStart(0),
+        pressUsed(false), taps(0), tapDeadline(0), gestureCount(0) {}
+
+  // Also call after light sleep, whose GPIO wakeup replaces the interrupt
+  void begin() {
+    instance = this;
+    pinMode(pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pin), onEdge, CHANGE);
+  }
+
+  // Call every loop: turns buffered edges into gestures
+  void update(uint32_t now) {
+    while (edgeTail != edgeHead) {
+      const Edge &e = edges[edgeTail];
+      settle(e.time); // Did the previous level hold until this edge?
+      rawDown = e.level == LOW;
+      rawTime = e.time;
+      edgeTail = (edgeTail + 1) & (INPUT_EDGE_BUFFER - 1);
+    }
+    settle(now);
+
+    if (pressed && !pressUsed && now - pressStart >= INPUT_LONG_PRESS_MS) {
+      pressUsed = true;
+      taps = 0;
+      emit(LONG_PRESS);
+    }
+    if (taps == 1 && !pressed && (int32_t)(now - tapDeadline) >= 0) {
+      taps = 0;
+      emit(TAP);
+    }
+  }
+
+  // Oldest pending gesture, or NONE
+  Gesture nextGesture() {
+    if (gestureCount == 0) {
+      return NONE;
+    }
+    Gesture g = (Gesture)gestures[0];
+    for (int i = 1; i < gestureCount; i++) {
+      gestures[i - 1] = gestures[i];
+    }
+    gestureCount--;
+    return g;
+  }
+
+  // Drop everything pending and take the pin as it is now. A press in
+  // progress (e.g. the one that woke us from standby) makes no gesture.
+  void reset(uint32_t now) {
+    edgeTail = edgeHead;
+    gestureCount = 0;
+    taps = 0;
+    pressed = rawDown = digitalRead(pin) == LOW;
+    pressUsed = true;
+    rawTime = now;
+  }
+
+  bool isPressed() const { return pressed; }
+  uint16_t getEdgesDropped() const { return edgesDropped; }
+};
+
+ButtonInput *ButtonInput::instance = nullptr;
+
+#endif
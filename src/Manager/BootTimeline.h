@@ -0,0 +1,50 @@
+#ifndef BOOTTIMELINE_H
+#define BOOTTIMELINE_H
+
+#include <Arduino.h>
+
+// Records when each boot phase first completes (ms since reset) and logs
+// one grep-able line per phase, e.g. "BOOT wifi_up=1432 (fast)".
+// Compare the first_step figure across firmware versions to track
+// time-to-first-expression.
+class BootTimeline {
+public:
+  enum Phase { DISPLAY_READY, WIFI_UP, FIRST_FETCH, FIRST_STEP, PHASE_COUNT };
+
+private:
+  unsigned long times[PHASE_COUNT];
+  bool marked[PHASE_COUNT];
+
+  static const char *phaseName(Phase p) {
+    static const char *names[PHASE_COUNT] = {"display_ready", "wifi_up",
+                                             "first_fetch", "first_step"};
+    return names[p];
+  }
+
+public:
+  BootTimeline() {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      times[i] = 0;
+      marked[i] = false;
+    }
+  }
+
+  // Only the first mark of each phase counts
+  void mark(Phase p, const char *note = nullptr) {
+    if (marked[p]) {
+      return;
+    }
+    marked[p] = true;
+    times[p] = millis();
+    if (note) {
+      Serial.printf("BOOT %s=%lu (%s)\n", phaseName(p), times[p], note);
+    } else {
+      Serial.printf("BOOT %s=%lu\n", phaseName(p), times[p]);
+    }
+  }
+
+  bool isMarked(Phase p) const { return marked[p]; }
+  unsigned long get(Phase p) const { return times[p]; }
+};
+
+#endif
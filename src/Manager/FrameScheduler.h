@@ -0,0 +1,64 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <Arduino.h>
+
+// Target render rate. Override in Config.h or with -D TARGET_FPS=...
+#ifndef TARGET_FPS
+#define TARGET_FPS 30
+#endif
+
+// Paces rendering to a fixed frame rate, independent of how fast loop()
+// spins. Call frameDue() every loop; it returns true once per frame slot.
+// If the loop stalls (e.g. during a network call) missed frames are dropped
+// instead of being rendered back-to-back to catch up.
+class FrameScheduler {
+private:
+  unsigned long frameInterval; // ms
+  unsigned long nextFrameTime;
+  bool started;
+
+public:
+  FrameScheduler(int fps = TARGET_FPS) : nextFrameTime(0), started(false) {
+    setTargetFps(fps);
+  }
+
+  void setTargetFps(int fps) {
+    if (fps < 1)
+      fps = 1;
+    frameInterval = 1000 / fps;
+    if (frameInterval == 0)
+      frameInterval = 1;
+  }
+
+  unsigned long getFrameInterval() const { return frameInterval; }
+
+  bool frameDue(unsigned long now) {
+    if (!started) {
+      started = true;
+      nextFrameTime = now + frameInterval;
+      return true;
+    }
+
+    // Signed difference keeps this correct across millis() rollover
+    if ((long)(now - nextFrameTime) < 0) {
+      return false;
+    }
+
+    nextFrameTime += frameInterval;
+    // Fell more than a frame behind: resync rather than burst
+    if ((long)(now - nextFrameTime) >= 0) {
+      nextFrameTime = now + frameInterval;
+    }
+    return true;
+  }
+
+  // Milliseconds left until the next frame slot (0 if already due)
+  unsigned long timeUntilNextFrame(unsigned long now) const {
+    if (!started || (long)(now - nextFrameTime) >= 0)
+      return 0;
+    return nextFrameTime - now;
+  }
+};
+
+#endif
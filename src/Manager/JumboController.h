@@ -1,6 +1,8 @@
 #ifndef JUMBOCONTROLLER_H
 #define JUMBOCONTROLLER_H
 
+#include "../Debug/LoopProfiler.h"
+#include "../Display/FrameFlusher.h"
 #include "../Face/Eye.h"
 #include "../Sequence/SequenceQueue.h"
 #include "../SoundManager.h"
@@ -8,14 +10,27 @@
 #include <Arduino.h>
 #include <U8g2lib.h>
 
+// Random gap between idle blinks (ms)
+#define BLINK_MIN_INTERVAL 2000
+#define BLINK_MAX_INTERVAL 6000
+
 class JumboController {
 private:
   U8G2 &u8g2; // Reference to display driver
+  FrameFlusher flusher; // Sends only the tiles that changed
 
   // Eyes
   Eye leftEye;
   Eye rightEye;
 
+#if EYE_SPRITE_CACHE
+  // Pre-rendered expressions, filled in begin(). One per eye: U8g2 does
+  // not promise a mirror-symmetric triangle fill, so the left eye's images
+  // flipped could be a pixel off the live right eye.
+  EyeSpriteCache leftSprites;
+  EyeSpriteCache rightSprites;
+#endif
+
   // Text Box
   TextBox statusBox;
   TextBox captionBox;
@@ -29,30 +44,38 @@ private:
   bool isPlayingStep;
   unsigned long stepStartTime;
   // Cache current step properties
-  float currentDisplayDuration;
-
-  // Helper to Convert String to Expression Enum
-  Eye::Expression getExpressionFromString(String s) {
-    s.toLowerCase();
-    if (s == "happy")
-      return Eye::EXPR_HAPPY;
-    if (s == "shocked")
-      return Eye::EXPR_SHOCKED;
-    if (s == "sad")
-      return Eye::EXPR_SAD;
-    if (s == "calm")
-      return Eye::EXPR_CALM;
-    if (s == "sleep")
-      return Eye::EXPR_SLEEP;
-    return Eye::EXPR_ANGRY;
+  unsigned long currentDisplayMs;
+
+  // Blinks are scheduled in time, not rolled per loop iteration, so the
+  // blink rate doesn't depend on how fast loop() runs.
+  unsigned long nextBlinkTime;
+
+  // Text or step changed since the last draw
+  bool frameDirty;
+
+  void scheduleNextBlink(unsigned long now) {
+    nextBlinkTime = now + random(BLINK_MIN_INTERVAL, BLINK_MAX_INTERVAL);
+  }
+
+  // One pass of draw(): everything on screen, into the current buffer
+  void drawScene() {
+    leftEye.draw(u8g2);
+    rightEye.draw(u8g2);
+
+    if (isPlayingStep) {
+      captionBox.draw(u8g2);
+    } else {
+      statusBox.draw(u8g2);
+    }
   }
 
 public:
   JumboController(U8G2 &_u8g2, SequenceQueue &_queue, int buzzerPin)
-      : u8g2(_u8g2), queue(_queue), leftEye(32, 26, 20, true),
-        rightEye(96, 26, 20, false), statusBox(0, 0, 12, 128, ALIGN_CENTER),
+      : u8g2(_u8g2), leftEye(32, 26, 20, true), rightEye(96, 26, 20, false),
+        statusBox(0, 0, 12, 128, ALIGN_CENTER),
         captionBox(0, 50, 12, 128, ALIGN_LEFT), buzzer(buzzerPin),
-        isPlayingStep(false), stepStartTime(0) {
+        queue(_queue), isPlayingStep(false), stepStartTime(0),
+        currentDisplayMs(0), nextBlinkTime(0), frameDirty(true) {
     // Initial State
     leftEye.setExpression(Eye::EXPR_SLEEP, 0);
     rightEye.setExpression(Eye::EXPR_SLEEP, 0);
@@ -60,41 +83,52 @@ public:
   }
 
   void begin() {
-    // Any init logic
+#if EYE_SPRITE_CACHE
+    leftEye.buildSprites(u8g2, leftSprites);
+    rightEye.buildSprites(u8g2, rightSprites);
+#endif
+
+    // First frame after boot must reach the whole panel
+    flusher.invalidate();
+    scheduleNextBlink(millis());
   }
 
   void update() {
+    PROFILE_SCOPE(PROF_CONTROLLER);
     unsigned long now = millis();
-    SequenceStep currentStep;
 
     // 1. Check State Machine
     if (isPlayingStep) {
       // Check if duration expired
-      if (now - stepStartTime >=
-          (unsigned long)(currentDisplayDuration * 1000)) {
+      if (now - stepStartTime >= currentDisplayMs) {
         // Step Finished
         isPlayingStep = false;
+        frameDirty = true;
         queue.pop(); // Remove the finished step
       }
     }
 
     // 2. Try to start next step if idle
     if (!isPlayingStep) {
-      if (queue.peek(currentStep)) {
+      const SequenceStep *currentStep = queue.peek();
+      if (currentStep) {
         // START NEW STEP
         isPlayingStep = true;
         stepStartTime = now;
-        currentDisplayDuration = currentStep.displayDuration;
+        frameDirty = true;
+        queue.markHeadStarted(now);
+        currentDisplayMs = currentStep->displayMs;
 
         // Apply Effects
-        Eye::Expression expr = getExpressionFromString(currentStep.expression);
-        leftEye.setExpression(expr, 500);
-        rightEye.setExpression(expr, 500);
+        leftEye.setExpression(currentStep->expression, 500);
+        rightEye.setExpression(currentStep->expression, 500);
 
-        captionBox.setText(currentStep.text);
+        captionBox.setText(currentStep->text);
 
-        if (currentStep.beepDuration > 0) {
-          buzzer.beep((int)(currentStep.beepDuration * 1000));
+        if (currentStep->soundPattern != SOUND_NONE) {
+          buzzer.play(currentStep->soundPattern);
+        } else if (currentStep->beepMs > 0) {
+          buzzer.beep(currentStep->beepMs);
         }
       } else {
         // IDLE / SLEEP STATE
@@ -103,23 +137,23 @@ public:
         if (leftEye.currentExpr != Eye::EXPR_SLEEP) {
           leftEye.setExpression(Eye::EXPR_SLEEP, 1000);
           rightEye.setExpression(Eye::EXPR_SLEEP, 1000);
-          statusBox.setText("Sleeping...");
+          frameDirty |= statusBox.setText("Sleeping...");
         }
       }
     }
 
     // 3. Update Components
     // Blink logic only if NOT sleeping
-    if (leftEye.currentExpr != Eye::EXPR_SLEEP) {
-      if (random(0, 1000) < 15) { // 1.5% chance
+    if ((long)(now - nextBlinkTime) >= 0) {
+      if (leftEye.currentExpr != Eye::EXPR_SLEEP) {
         leftEye.blink();
         rightEye.blink();
       }
+      scheduleNextBlink(now);
     }
 
     leftEye.update();
     rightEye.update();
-    buzzer.update();
   }
 
   void setExpression(Eye::Expression e, int duration) {
@@ -127,20 +161,49 @@ public:
     rightEye.setExpression(e, duration);
   }
 
-  void setText(String s) { statusBox.setText(s); }
+  bool isPlaying() const { return isPlayingStep; }
+
+  // End the current step now; update() moves on to the next one
+  void skipStep() {
+    if (isPlayingStep) {
+      currentDisplayMs = 0;
+    }
+  }
 
+  void setText(const char *s) { frameDirty |= statusBox.setText(s); }
+
+  // True if the next draw() would produce a different picture
+  bool needsRedraw() const {
+    return frameDirty || leftEye.dirty || rightEye.dirty;
+  }
+
+  // Works with a full buffer (one pass) or a page buffer: the scene is
+  // then drawn once per band of pages, each pass clipped to its band
+  // (the U8g2 picture loop, without resending unchanged bands).
   void draw() {
-    u8g2.clearBuffer();
-    leftEye.draw(u8g2);
-    rightEye.draw(u8g2);
+    int pages = u8g2.getDisplayHeight() / 8;
+    int band = u8g2.getBufferTileHeight();
+    bool paged = FrameFlusher::isPaged(u8g2);
 
-    if (isPlayingStep) {
-      captionBox.draw(u8g2);
-    } else {
-      statusBox.draw(u8g2);
+    for (int page = 0; page < pages; page += band) {
+      if (paged) {
+        u8g2.setBufferCurrTileRow(page);
+      }
+      u8g2.clearBuffer();
+      drawScene();
+      flusher.flush(u8g2);
     }
 
-    u8g2.sendBuffer();
+    frameDirty = false;
+    leftEye.dirty = false;
+    rightEye.dirty = false;
+  }
+
+  // Force the next draw() to resend the whole frame, e.g. after the panel
+  // was powered down or written by someone else.
+  void invalidateDisplay() {
+    flusher.invalidate();
+    frameDirty = true;
   }
 
   void forceSleep() {
@@ -149,7 +212,8 @@ public:
     rightEye.setExpression(Eye::EXPR_SLEEP, 0);
 
     // 2. Set Status Text
-    statusBox.setText("Sleeping...");
+    frameDirty |= statusBox.setText("Sleeping...");
+    buzzer.stop();
 
     // 3. Force Draw immediately to update screen before loop pauses
     draw();
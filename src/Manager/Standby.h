@@ -0,0 +1,122 @@
+#ifndef STANDBY_H
+#define STANDBY_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+extern "C" {
+#include "gpio.h"
+#include "user_interface.h"
+}
+
+// Resume budgets, from the wake-up edge: the first redrawn frame, and
+// WiFi back up (fast reconnect, see WiFiFastConnect.h)
+#ifndef STANDBY_FRAME_BUDGET_MS
+#define STANDBY_FRAME_BUDGET_MS 100
+#endif
+#ifndef STANDBY_WIFI_BUDGET_MS
+#define STANDBY_WIFI_BUDGET_MS 3000
+#endif
+
+// Low-power standby: the radio is switched off (modem sleep) and the CPU
+// is parked in forced light sleep until the wake pin is pulled low. Nothing
+// runs while asleep, so the display keeps the last frame it was sent.
+//
+// After a wake the time to the first redrawn frame and to WiFi being back
+// is measured against the budgets above and reported on serial.
+class Standby {
+private:
+  uint8_t wakePin;
+  bool active;
+
+  // Resume measurement (micros() since the wake callback)
+  bool measuring;
+  bool frameReported;
+  bool wifiReported;
+  static volatile uint32_t wakeMicros;
+
+  static void onWake() { wakeMicros = micros(); }
+
+  void report(const char *what, uint32_t ms, uint32_t budget) {
+    Serial.printf("RESUME %s=%lums (budget %lums)%s\n", what,
+                  (unsigned long)ms, (unsigned long)budget,
+                  ms > budget ? " OVER BUDGET" : "");
+  }
+
+public:
+  Standby(uint8_t pin)
+      : wakePin(pin), active(false), measuring(false), frameReported(false),
+        wifiReported(false) {}
+
+  bool isActive() const { return active; }
+
+  // Radio off. Call after the sleep frame has been drawn.
+  void enter() {
+    active = true;
+    measuring = false;
+    WiFi.mode(WIFI_OFF);
+    WiFi.forceSleepBegin();
+    delay(1);
+  }
+
+  // Light-sleep until the wake pin goes low. Returns true if woken by the
+  // pin; false if the pin was still held (e.g. the press that started
+  // standby), so call again from the next loop().
+  bool sleep() {
+    if (digitalRead(wakePin) == LOW) {
+      delay(20);
+      return false;
+    }
+
+    wakeMicros = 0;
+    wifi_set_opmode_current(NULL_MODE);
+    wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+    wifi_fpm_open();
+    gpio_pin_wakeup_enable(GPIO_ID_PIN(wakePin), GPIO_PIN_INTR_LOLEVEL);
+    wifi_fpm_set_wakeup_cb(onWake);
+    wifi_fpm_do_sleep(0xFFFFFFF); // Until the GPIO wakes us
+    delay(10);                    // The SDK sleeps during this yield
+
+    gpio_pin_wakeup_disable();
+    wifi_fpm_close();
+    if (wakeMicros == 0) {
+      wakeMicros = micros(); // Callback missed, measure from here
+    }
+    return true;
+  }
+
+  // Radio back on; APIClient reconnects on its next update()
+  void exit() {
+    active = false;
+    WiFi.forceSleepWake();
+    delay(1);
+    measuring = true;
+    frameReported = false;
+    wifiReported = false;
+  }
+
+  // Call after each draw(), and every loop while awake
+  void frameShown() {
+    if (measuring && !frameReported) {
+      frameReported = true;
+      report("frame", (micros() - wakeMicros) / 1000,
+             STANDBY_FRAME_BUDGET_MS);
+    }
+  }
+
+  void update() {
+    if (!measuring) {
+      return;
+    }
+    if (!wifiReported && WiFi.status() == WL_CONNECTED) {
+      wifiReported = true;
+      report("wifi", (micros() - wakeMicros) / 1000,
+             STANDBY_WIFI_BUDGET_MS);
+    }
+    measuring = !(frameReported && wifiReported);
+  }
+};
+
+volatile uint32_t Standby::wakeMicros = 0;
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Integer math helpers for targets without an FPU (the ESP8266 emulates
+// every float operation in software).
+//
+// fix8_t is Q8.8: 8 integer bits, 8 fraction bits, so 1.0 == 256.
+// Angles are "binary degrees": 256 steps per full turn.
+
+typedef int32_t fix8_t;
+
+#define FIX8_SHIFT 8
+#define FIX8_ONE (1 << FIX8_SHIFT)
+
+// Compile-time conversion from a float literal. Rounds up (toward +inf)
+// so a product that is a whole number in decimal (20 * 0.8 == 16) never
+// lands just below it and truncates one pixel short of the float path.
+constexpr fix8_t fix8FromFloat(float v) {
+  return ((float)(fix8_t)(v * FIX8_ONE) < v * FIX8_ONE)
+             ? (fix8_t)(v * FIX8_ONE) + 1
+             : (fix8_t)(v * FIX8_ONE);
+}
+
+// Truncates toward zero, matching a float -> int cast
+inline int fix8ToInt(fix8_t v) { return v / FIX8_ONE; }
+
+// a + (b - a) * t, with t in 0..FIX8_ONE
+inline fix8_t fix8Lerp(fix8_t a, fix8_t b, fix8_t t) {
+  return a + (((b - a) * t) >> FIX8_SHIFT);
+}
+
+// Quarter sine wave, Q1.14 (16384 == 1.0), 64 steps + endpoint
+static const int16_t SINE_QUARTER_Q14[65] PROGMEM = {
+    0,     402,   804,   1205,  1606,  2006,  2404,  2801,  3196,  3590,
+    3981,  4370,  4756,  5139,  5520,  5897,  6270,  6639,  7005,  7366,
+    7723,  8076,  8423,  8765,  9102,  9434,  9760,  10080, 10394, 10702,
+    11003, 11297, 11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+    13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978, 15137, 15286,
+    15426, 15557, 15679, 15791, 15893, 15986, 16069, 16143, 16207, 16261,
+    16305, 16340, 16364, 16379, 16384};
+
+// sin() of a binary angle (256 per turn), result in Q1.14
+inline int32_t sinLutQ14(uint8_t angle) {
+  uint8_t quadrant = angle >> 6;
+  uint8_t step = angle & 63;
+  if (quadrant & 1)
+    step = 64 - step;
+  int32_t v = (int16_t)pgm_read_word(&SINE_QUARTER_Q14[step]);
+  return (quadrant & 2) ? -v : v;
+}
+
+// Milliseconds to a binary angle for sin(ms / periodDiv). The multiplier
+// is 256 / (2 * PI * periodDiv) in Q16.16; 64-bit keeps long uptimes exact.
+inline uint8_t msToBinaryAngle(unsigned long ms, uint32_t multiplierQ16) {
+  return (uint8_t)(((uint64_t)ms * multiplierQ16) >> 16);
+}
+
+// floor(sqrt(v)), bit-by-bit, no division
+inline uint32_t isqrt32(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > v)
+    bit >>= 2;
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+#endif
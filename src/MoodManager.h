@@ -3,57 +3,41 @@
 
 #include <Arduino.h>
 #include "FaceFeatures.h" // To access the Mood enum
+#include "Input/ButtonInput.h"
 
 class MoodManager {
   private:
-    int buttonPin;
+    ButtonInput &input;
     int currentMoodIndex;
-    
-    // Debounce variables to prevent "double clicks"
-    unsigned long lastPressTime;
-    int lastState;
 
   public:
-    MoodManager(int pin) {
-      buttonPin = pin;
+    MoodManager(ButtonInput &_input) : input(_input) {
       currentMoodIndex = 0; // Start at HAPPY (0)
-      lastPressTime = 0;
-      lastState = HIGH; // Button is usually HIGH (Unpressed)
     }
 
     void begin() {
-      // D3 (Flash Button) needs internal pull-up resistor
-      pinMode(buttonPin, INPUT_PULLUP); 
+      input.begin(); // Safe to call again if main already did
     }
 
     // Call this in your loop. It returns the NEW mood if changed, or -1 if nothing happened.
+    // Tap: next mood. Double-tap: previous mood. Long-press: back to HAPPY.
     int checkInput() {
-      int reading = digitalRead(buttonPin);
-      unsigned long now = millis();
-
-      // Detect a "Press" (falling edge: HIGH -> LOW)
-      // We also enforce a 200ms "cooldown" so you can't cycle too fast
-      if (lastState == HIGH && reading == LOW && (now - lastPressTime > 200)) {
-        
-        lastPressTime = now;
-        
-        // Cycle the Mood
-        // There are 5 moods (0 to 4). (HAPPY, NEUTRAL, SAD, ANGRY, SLEEPY)
-        currentMoodIndex++;
-        if (currentMoodIndex > 4) {
-          currentMoodIndex = 0; // Loop back to HAPPY
-        }
-        
-        lastState = reading; // Remember it's pressed
-        return currentMoodIndex;
+      input.update(millis());
+
+      // There are 5 moods (0 to 4). (HAPPY, NEUTRAL, SAD, ANGRY, SLEEPY)
+      switch (input.nextGesture()) {
+        case ButtonInput::TAP:
+          currentMoodIndex = (currentMoodIndex + 1) % 5;
+          return currentMoodIndex;
+        case ButtonInput::DOUBLE_TAP:
+          currentMoodIndex = (currentMoodIndex + 4) % 5;
+          return currentMoodIndex;
+        case ButtonInput::LONG_PRESS:
+          currentMoodIndex = 0; // Back to HAPPY
+          return currentMoodIndex;
+        default:
+          return -1; // No change
       }
-      
-      // Reset state when button is released
-      if (reading == HIGH) {
-        lastState = HIGH;
-      }
-
-      return -1; // No change
     }
     
     // Helper to convert Integer back to Mood Enum
@@ -62,4 +46,4 @@ class MoodManager {
     }
 };
 
-#endif
\ No newline at end of file
+#endif
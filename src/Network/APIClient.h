@@ -2,49 +2,190 @@
 #define APICLIENT_H
 
 #include "../Config.h"
+#include "../Debug/LoopProfiler.h"
+#include "../Manager/BootTimeline.h"
 #include "../Sequence/SequenceQueue.h"
+#include "../Sequence/StepBatch.h"
+#include "AsyncHttpRequest.h"
+#include "BinaryStepStream.h"
+#include "HttpUrl.h"
+#include "JsonArrayStream.h"
+#include "SseStream.h"
+#include "StreamInflater.h"
+#include "WiFiFastConnect.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <ESP8266HTTPClient.h>
 #include <ESP8266WiFi.h>
 #include <WiFiClientSecureBearSSL.h>
 #include <functional>
+#include <stdarg.h>
+
+// Ask the server for the packed step format (BinaryStepStream.h). Servers
+// that don't know it keep answering with JSON.
+#ifndef API_BINARY_STEPS
+#define API_BINARY_STEPS 0
+#endif
+
+// Offer gzip/deflate (Accept-Encoding) and inflate responses on the fly
+// through a 4 KB window (StreamInflater.h). Costs ~5.5 KB of RAM. If a
+// response needs a bigger window, it is fetched again uncompressed and
+// compression is not offered again until reboot.
+#ifndef API_COMPRESSION
+#define API_COMPRESSION 0
+#endif
+
+// TLS record size to negotiate (MFLN). Shrinks BearSSL's buffers from
+// ~16 KB + 16 KB to this, if the server supports it.
+#define TLS_MFLN_SIZE 512
+
+// One filtered step object (four fields plus the copied strings)
+#define STEP_DOC_SIZE 384
+
+// Pause before retrying a failed boot fetch, so the error stays readable
+#define BOOT_RETRY_DELAY 2000
+
+// Longest ETag remembered for conditional fetches
+#define ETAG_MAX 48
+
+// Fixed buffers for the status line and the request (no String churn)
+#define STATUS_TEXT_MAX 40
+#define REQUEST_BODY_MAX 64
+#define REQUEST_HEADERS_MAX 320
+
+// Refill watermark: fetch when the queue has less playback left than
+// twice the (smoothed) fetch latency plus this margin
+#define PREFETCH_MARGIN_MS 1000
+#define PREFETCH_INITIAL_LATENCY 2000
+// Minimum gap between fetches that did return steps
+#define PREFETCH_MIN_GAP 1000
+
+// Push mode: with API_STREAM_URL defined in Config.h, the device holds a
+// Server-Sent Events stream open and queues steps as the server emits
+// them. Polling only runs while the stream is down.
+#ifdef API_STREAM_URL
+#define API_PUSH 1
+#else
+#define API_PUSH 0
+#endif
+
+#define PUSH_RETRY_MIN 2000
+#define PUSH_RETRY_MAX 60000
+// The server sends a ": ping" comment more often than this
+#define PUSH_IDLE_TIMEOUT 45000
 
 class APIClient {
 private:
   SequenceQueue &queue;
-  unsigned long lastCheckTime;
-  unsigned long checkInterval;
+  unsigned long lastCheckTime; // Last fetch start
+  unsigned long checkInterval; // Gap after a fetch that brought nothing
 
   // Boot Logic State
-  String bootStatus;
+  char bootStatus[STATUS_TEXT_MAX + 1];
   bool initialFetchDone;
   bool isConnected;
   int bootState; // 0=Wait WiFi, 1=Connected Wait, 2=Fetching, 3=Done Wait
+  unsigned long nextBootAttempt;
+  WiFiFastConnect wifi;
+  BootTimeline *timeline; // Optional, see setBootTimeline()
+
+  // In-flight request
+  enum FetchResult { FETCH_RUNNING, FETCH_OK, FETCH_FAILED };
+  HttpUrl apiUrl;
+  AsyncHttpRequest request;
+  unsigned long fetchStartTime;
+  unsigned long fetchLatencyMs; // Moving average of successful fetches
+  bool lastFetchEmpty;
+
+  // Long-lived connection, reused across fetches (keep-alive)
+  WiFiClient plainClient;
+  BearSSL::WiFiClientSecure secureClient;
+  BearSSL::Session tlsSession; // Lets a reconnect skip the full handshake
+  bool tlsConfigured;
+  AsyncHttpRequest::State lastRequestState;
+  bool fetchInFlight;
+  const char *fetchMessage; // MSG_BOOT / MSG_REPEAT of the current fetch
+
+  // Streaming ingestion: array elements are parsed as they complete
+  JsonArrayStream stepStream;
+  StaticJsonDocument<128> stepFilter;
+  BinaryStepStream binaryStream;
+  bool binaryResponse; // From the response Content-Type
+#if API_COMPRESSION
+  StreamInflater inflater;
+  bool compressedResponse; // From the response Content-Encoding
+  bool offerCompression;   // Cleared when the server's window is too big
+  bool refetchPlain;       // Retry the current fetch without compression
+#endif
+
+  // Conditional fetch: the server's version tag of the last batch we got.
+  // The tag is only adopted once its response was parsed completely.
+  char etag[ETAG_MAX + 1];
+  char pendingEtag[ETAG_MAX + 1];
+
+  // Steps of the response being read; they reach the queue only once it
+  // has arrived completely
+  StepBatch staging;
 
-  using StatusCallback = std::function<void(const String &)>;
+#if API_PUSH
+  // Event stream, on its own connection
+  HttpUrl streamUrl;
+  AsyncHttpRequest pushRequest;
+  WiFiClient pushPlainClient;
+  BearSSL::WiFiClientSecure pushSecureClient;
+  BearSSL::Session pushTlsSession;
+  SseStream pushEvents;
+  bool pushActive; // Request started and not yet ended
+  bool pushLive;   // Server accepted it and events are flowing
+  unsigned long nextPushAttempt;
+  unsigned long pushRetryDelay;
+#endif
+
+  using StatusCallback = std::function<void(const char *)>;
   StatusCallback statusCallback;
 
-  void updateStatus(String msg) {
-    bootStatus = msg;
+  // Handed every complete, non-empty batch before it joins the queue
+  using BatchCallback = std::function<void(const StepBatch &)>;
+  BatchCallback batchCallback;
+
+  void updateStatus(const char *msg) {
+    strncpy(bootStatus, msg, STATUS_TEXT_MAX);
+    bootStatus[STATUS_TEXT_MAX] = '\0';
     if (statusCallback) {
-      statusCallback(msg);
+      statusCallback(bootStatus);
     }
   }
 
+  // printf-style, formatted in place (no String temporaries)
+  __attribute__((format(printf, 2, 3))) void updateStatusf(const char *fmt,
+                                                          ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(bootStatus, sizeof(bootStatus), fmt, args);
+    va_end(args);
+    if (statusCallback) {
+      statusCallback(bootStatus);
+    }
+  }
+
+  void updateStatusIp(const char *prefix, const char *suffix) {
+    IPAddress ip = WiFi.localIP();
+    updateStatusf("%s%u.%u.%u.%u%s", prefix, ip[0], ip[1], ip[2], ip[3],
+                  suffix);
+  }
+
   void connectWiFi() {
     if (WiFi.status() == WL_CONNECTED) {
-      isConnected = true;
-      return;
+      return; // update() picks it up
     }
 
     // This is non-blocking (starts connection process)
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    updateStatus("Connecting to wifi...");
+    wifi.begin();
+    updateStatus(wifi.usedFastPath() ? "Reconnecting to wifi..."
+                                     : "Connecting to wifi...");
   }
 
-  bool fetchSequences(const char *messageType) {
+  // Start a request. Progress happens in pollFetch(), one slice per update().
+  bool startFetch(const char *messageType) {
     if (WiFi.status() != WL_CONNECTED) {
       updateStatus("Error: WiFi lost!");
       return false;
@@ -55,117 +196,502 @@ private:
     // Build JSON Payload
     StaticJsonDocument<200> doc;
     doc["message"] = messageType;
-    String requestBody;
-    serializeJson(doc, requestBody);
+    char requestBody[REQUEST_BODY_MAX];
+    serializeJson(doc, requestBody, sizeof(requestBody));
 
     // Choose Client based on Protocol
-    if (String(API_URL).startsWith("https")) {
-      std::unique_ptr<BearSSL::WiFiClientSecure> client(
-          new BearSSL::WiFiClientSecure);
-      client->setInsecure();
-      return executeRequest(*client, requestBody);
-    } else {
-      std::unique_ptr<WiFiClient> client(new WiFiClient);
-      return executeRequest(*client, requestBody);
-    }
-  }
+    // (TLS buffers were set up by configureTls() in the boot sequence)
+    WiFiClient *client = apiUrl.secure ? &secureClient : &plainClient;
 
-  bool executeRequest(WiFiClient &client, String &requestBody) {
-    HTTPClient http;
     updateStatus("Connecting API...");
     Serial.print("Sending API Request: ");
     Serial.println(API_URL);
 
-    if (http.begin(client, API_URL)) {
-      http.addHeader("Content-Type", "application/json");
-      http.addHeader("Authorization", String("Bearer ") + API_TOKEN);
-
-      updateStatus("Post " + WiFi.localIP().toString() + "..");
-      int httpCode = http.POST(requestBody);
-
-      if (httpCode > 0) {
-        Serial.printf("HTTP Code: %d\n", httpCode);
-        if (httpCode == HTTP_CODE_OK) {
-          updateStatus("Reading data...");
-          String payload = http.getString();
-          updateStatus("Parsing JSON...");
-          parseResponse(payload);
-          http.end();
-          return true;
-        } else {
-          updateStatus("HTTP Err: " + String(httpCode));
-        }
-      } else {
-        updateStatus("Fail(" + String(httpCode) +
-                     "): " + http.errorToString(httpCode));
+    static const char headerFormat[] =
+        "Content-Type: application/json\r\n"
+        "Authorization: Bearer %s\r\n"
+#if API_BINARY_STEPS
+        "Accept: " STEP_WIRE_CONTENT_TYPE ", application/json;q=0.5\r\n"
+#endif
+#if API_COMPRESSION
+        "%s"
+#endif
+        "%s%s%s";
+    // The boot message always wants a fresh batch
+    bool conditional = etag[0] && strcmp(messageType, MSG_BOOT) != 0;
+    char headers[REQUEST_HEADERS_MAX];
+    snprintf(headers, sizeof(headers), headerFormat, API_TOKEN,
+#if API_COMPRESSION
+             offerCompression ? "Accept-Encoding: gzip, deflate\r\n" : "",
+#endif
+             conditional ? "If-None-Match: " : "", conditional ? etag : "",
+             conditional ? "\r\n" : "");
+#if API_COMPRESSION
+    compressedResponse = false;
+    refetchPlain = false;
+#endif
+    pendingEtag[0] = '\0';
+
+    stepStream.reset();
+    binaryStream.reset();
+    binaryResponse = false;
+    lastRequestState = AsyncHttpRequest::STATE_CONNECTING;
+    request.startPost(*client, apiUrl, requestBody, headers);
+    fetchMessage = messageType;
+    fetchInFlight = true;
+    fetchStartTime = millis();
+    return true;
+  }
+
+  static bool probeMfln(const HttpUrl &url) {
+    bool ok = BearSSL::WiFiClientSecure::probeMaxFragmentLength(
+        url.host.c_str(), url.port, TLS_MFLN_SIZE);
+    Serial.printf("TLS: %s %s MFLN %d\n", url.host.c_str(),
+                  ok ? "supports" : "does not support", TLS_MFLN_SIZE);
+    return ok;
+  }
+
+  static void configureTlsClient(BearSSL::WiFiClientSecure &client,
+                                 BearSSL::Session &session, bool mfln) {
+    client.setInsecure();
+    client.setSession(&session);
+    if (mfln) {
+      client.setBufferSizes(TLS_MFLN_SIZE, TLS_MFLN_SIZE);
+    }
+  }
+
+  // Once per boot, as a step of the boot sequence before the first fetch.
+  // Each probe is a blocking connection of its own, so this never runs
+  // from the fetch or push paths.
+  void configureTls() {
+    tlsConfigured = true;
+    bool apiMfln = false;
+    if (apiUrl.secure) {
+      apiMfln = probeMfln(apiUrl);
+      configureTlsClient(secureClient, tlsSession, apiMfln);
+    }
+#if API_PUSH
+    if (streamUrl.secure) {
+      // Usually the same server: reuse the answer instead of asking again
+      bool sameServer = apiUrl.secure && streamUrl.host == apiUrl.host &&
+                        streamUrl.port == apiUrl.port;
+      configureTlsClient(pushSecureClient, pushTlsSession,
+                         sameServer ? apiMfln : probeMfln(streamUrl));
+    }
+#endif
+  }
+
+  bool needsTls() const {
+#if API_PUSH
+    if (streamUrl.secure) {
+      return true;
+    }
+#endif
+    return apiUrl.secure;
+  }
+
+  // Advance the in-flight request by one bounded slice
+  FetchResult pollFetch() {
+    AsyncHttpRequest::State state = request.poll();
+
+    if (state != lastRequestState) {
+      lastRequestState = state;
+      if (state == AsyncHttpRequest::STATE_SENDING) {
+        updateStatusIp("Post ", "..");
+      } else if (state == AsyncHttpRequest::STATE_READING_BODY) {
+        updateStatus("Reading data...");
+      }
+    }
+
+    if (state == AsyncHttpRequest::STATE_FAILED) {
+#if API_COMPRESSION
+      if (refetchPlain) {
+        staging.discard();
+        endFetch();
+        Serial.println("Gzip window over 4 KB, fetching uncompressed");
+        return startFetch(fetchMessage) ? FETCH_RUNNING : FETCH_FAILED;
       }
-      http.end();
+#endif
+      updateStatusf("Fail: %s", request.getError());
+      staging.discard();
+      lastFetchEmpty = true;
+      endFetch();
+      return FETCH_FAILED;
+    }
+    if (state != AsyncHttpRequest::STATE_DONE) {
+      return FETCH_RUNNING;
+    }
+
+    int httpCode = request.getStatusCode();
+    unsigned long latency = millis() - fetchStartTime;
+    Serial.printf("HTTP Code: %d (%lums, %s connection, heap %u)\n",
+                  httpCode, latency, request.wasReused() ? "reused" : "new",
+                  ESP.getFreeHeap());
+    bool ok = false;
+    bool unchanged = httpCode == 304 || httpCode == 204 ||
+                     (httpCode == 200 && request.getBodyReceived() == 0);
+    if (unchanged) {
+      // Nothing new: no body was read, nothing to parse or queue
+      Serial.println("No new steps.");
+      ok = true;
+      lastFetchEmpty = true;
+      fetchLatencyMs = (fetchLatencyMs * 3 + latency) / 4;
+    } else if (httpCode == 200) {
+      ok = finishResponse();
+      fetchLatencyMs = (fetchLatencyMs * 3 + latency) / 4;
     } else {
-      updateStatus("Conn Failed!");
+      updateStatusf("HTTP Err: %d", httpCode);
     }
-    return false;
+    if (!ok) {
+      staging.discard();
+      lastFetchEmpty = true;
+    }
+    endFetch();
+    return ok ? FETCH_OK : FETCH_FAILED;
+  }
+
+  void endFetch() {
+    fetchInFlight = false;
+  }
+
+  // Drop the fetch in flight along with the steps it staged
+  void abortFetch() {
+    request.abort();
+    staging.discard();
+    endFetch();
   }
 
-  bool parseResponse(String &json) {
+  // Seconds from the server to rounded milliseconds, clamped to
+  // [0, maxMs] before the cast: an out-of-range float to int conversion is
+  // undefined, and a negative or missing duration means none
+  static uint32_t msFromSeconds(float seconds, uint32_t maxMs) {
+    if (!(seconds > 0)) {
+      return 0;
+    }
+    float ms = seconds * 1000 + 0.5f;
+    return ms >= (float)maxMs ? maxMs : (uint32_t)ms;
+  }
+
+  // Called for each array element as soon as its closing brace arrives
+  bool decodeStep(const char *json, size_t len, SequenceStep &step) {
     // Expected usage:
-    // [{"expression": "...", ...}, ...]
-    // Adjust size based on expected complexity
-    DynamicJsonDocument doc(2048);
-    DeserializationError error = deserializeJson(doc, json);
+    // [{"Expression": "...", ...}, ...]
+    // Only the four step fields are kept, whatever else the server sends
+    StaticJsonDocument<STEP_DOC_SIZE> doc;
+    DeserializationError error = deserializeJson(
+        doc, json, len, DeserializationOption::Filter(stepFilter));
 
     if (error) {
       Serial.print("deserializeJson() failed: ");
       Serial.println(error.c_str());
-      updateStatus("JSON Err: " + String(error.c_str()));
+      updateStatusf("JSON Err: %s", error.c_str());
       return false;
     }
 
-    JsonArray array = doc.as<JsonArray>();
-    for (JsonObject v : array) {
-      SequenceStep step;
-      step.expression = v["Expression"].as<String>();
-      step.beepDuration = v["BuzzerDuration"].as<float>();
-      step.text = v["Text"].as<String>();
-      step.displayDuration = v["DisplayDuration"].as<float>();
+    // Resolve everything here so starting a step is plain data
+    JsonObject v = doc.as<JsonObject>();
+    step.expression = Eye::expressionFromName(v["Expression"]);
+    step.beepMs = msFromSeconds(v["BuzzerDuration"], UINT16_MAX);
+    step.soundPattern = soundPatternFromName(v["Sound"]);
+    step.displayMs = msFromSeconds(v["DisplayDuration"], UINT32_MAX);
+    step.setText(v["Text"]);
+    return true;
+  }
 
-      queue.add(step);
+  void addStep(const StepRecord &record) {
+    SequenceStep step;
+    step.expression = Eye::expressionFromId(record.expression);
+    step.beepMs = record.beepMs;
+    step.soundPattern = record.soundPattern < SOUND_PATTERN_COUNT
+                            ? record.soundPattern
+                            : SOUND_NONE;
+    step.displayMs = record.displayMs;
+    step.setText(record.text);
+    staging.add(step);
+  }
+
+  // The whole body is in: check it, then release the batch to the queue
+  bool finishResponse() {
+#if API_COMPRESSION
+    if (compressedResponse && !inflater.isFinished()) {
+      updateStatus("Gzip Err: truncated");
+      return false;
     }
-    Serial.printf("Added %d steps to queue.\n", array.size());
+#endif
+    if (binaryResponse) {
+      if (!binaryStream.isComplete()) {
+        updateStatus("Bin Err: truncated");
+        return false;
+      }
+    } else {
+      if (stepStream.getSkipped() > 0) {
+        Serial.printf("Skipped %d oversized steps.\n",
+                      stepStream.getSkipped());
+      }
+      if (!stepStream.isComplete()) {
+        updateStatus("JSON Err: not an array");
+        return false;
+      }
+    }
+
+    if (staging.getDropped() > 0) {
+      Serial.printf("Dropped %d steps over the batch size.\n",
+                    staging.getDropped());
+    }
+    lastFetchEmpty = staging.getStaged() == 0;
+    strcpy(etag, pendingEtag);
+    if (batchCallback && !staging.isEmpty()) {
+      batchCallback(staging);
+    }
+    staging.release();
+    int added = staging.commitTo(queue);
+    Serial.printf("Added %d steps to queue (%d waiting).\n", added,
+                  staging.size());
     return true;
   }
 
+  // Response body bytes (already inflated), into the matching step parser
+  bool decodeBody(const uint8_t *data, size_t len) {
+    if (binaryResponse) {
+      binaryStream.feed(data, len);
+      return !binaryStream.isMalformed();
+    }
+    stepStream.feed(data, len);
+    return !stepStream.isMalformed();
+  }
+
+  // Fetch when the queue is about to run dry: the playback time left is
+  // compared with how long a fetch has been taking.
+  bool needsRefill(unsigned long now) {
+    if (!staging.isEmpty() || queue.freeSlots() == 0) {
+      return false;
+    }
+    uint32_t watermark = fetchLatencyMs * 2 + PREFETCH_MARGIN_MS;
+    if (queue.remainingMs(now) > watermark) {
+      return false;
+    }
+    // Don't ask again right away if the server had nothing last time
+    unsigned long gap = lastFetchEmpty ? checkInterval : PREFETCH_MIN_GAP;
+    return now - lastCheckTime >= gap;
+  }
+
+#if API_PUSH
+  void startPush() {
+    // Configured (MFLN buffers, session) by configureTls() during boot
+    WiFiClient *client =
+        streamUrl.secure ? &pushSecureClient : &pushPlainClient;
+
+    char headers[REQUEST_HEADERS_MAX];
+    snprintf(headers, sizeof(headers),
+             "Accept: text/event-stream\r\n"
+             "Cache-Control: no-cache\r\n"
+             "Authorization: Bearer %s\r\n",
+             API_TOKEN);
+
+    pushEvents.reset();
+    pushRequest.startGet(*client, streamUrl, headers);
+    pushActive = true;
+  }
+
+  // Keep the stream open; reconnect with backoff when it drops
+  void updatePush(unsigned long now) {
+    if (pushActive) {
+      AsyncHttpRequest::State state = pushRequest.poll();
+      bool live = state == AsyncHttpRequest::STATE_READING_BODY &&
+                  pushRequest.getStatusCode() == 200;
+      if (live && !pushLive) {
+        Serial.println("Push stream open");
+        pushRetryDelay = PUSH_RETRY_MIN;
+      }
+      pushLive = live;
+      if (pushRequest.isBusy()) {
+        return;
+      }
+
+      // Ended: poll until the stream is back
+      Serial.printf("Push stream closed (%s), retry in %lums\n",
+                    pushRequest.getError(), pushRetryDelay);
+      pushActive = false;
+      pushLive = false;
+      nextPushAttempt = now + pushRetryDelay;
+      pushRetryDelay = min(pushRetryDelay * 2, (unsigned long)PUSH_RETRY_MAX);
+      return;
+    }
+
+    if ((long)(now - nextPushAttempt) >= 0) {
+      startPush();
+    }
+  }
+
+  void stopPush() {
+    if (pushActive) {
+      pushRequest.abort();
+      pushActive = false;
+      pushLive = false;
+    }
+  }
+#endif
+
 public:
   APIClient(SequenceQueue &_queue)
       : queue(_queue), lastCheckTime(0), checkInterval(10000),
         initialFetchDone(false), isConnected(false), bootState(0),
-        bootStatus("Booting...") {}
+        nextBootAttempt(0), wifi(WIFI_SSID, WIFI_PASSWORD),
+        timeline(nullptr), fetchStartTime(0),
+        fetchLatencyMs(PREFETCH_INITIAL_LATENCY), lastFetchEmpty(false),
+        tlsConfigured(false), lastRequestState(AsyncHttpRequest::STATE_IDLE),
+        fetchInFlight(false), fetchMessage(MSG_REPEAT), binaryResponse(false) {
+    strcpy(bootStatus, "Booting...");
+    apiUrl.parse(API_URL);
+
+#if API_COMPRESSION
+    compressedResponse = false;
+    offerCompression = true;
+    refetchPlain = false;
+    inflater.onOutputData([this](const uint8_t *data, size_t len) {
+      return decodeBody(data, len);
+    });
+#endif
+    etag[0] = '\0';
+    pendingEtag[0] = '\0';
+
+#if API_PUSH
+    streamUrl.parse(API_STREAM_URL);
+    pushActive = false;
+    pushLive = false;
+    nextPushAttempt = 0;
+    pushRetryDelay = PUSH_RETRY_MIN;
+
+    pushRequest.setKeepAlive(false);
+    pushRequest.setTimeout(PUSH_IDLE_TIMEOUT);
+    pushRequest.onBodyData([this](const uint8_t *data, size_t len) {
+      if (pushRequest.getStatusCode() == 200) {
+        if (fetchInFlight) {
+          abortFetch(); // The stream takes over before its first event
+        }
+        int dropped = pushEvents.getDropped();
+        pushEvents.feed(data, len);
+        if (pushEvents.getDropped() > dropped) {
+          Serial.printf("Push: skipped %d events over %d bytes.\n",
+                        pushEvents.getDropped() - dropped, SSE_DATA_MAX);
+        }
+      }
+      return true;
+    });
+
+    // Each "step" event carries one step object, same keys as the JSON API.
+    // A single event is always complete, so it goes straight to the queue
+    // (saved with it to /queue.bin); the batch is for fetched responses.
+    pushEvents.onEventReceived(
+        [this](const char *event, const char *data, size_t len) {
+          SequenceStep step;
+          if ((strcmp(event, "step") != 0 && strcmp(event, "message") != 0) ||
+              !decodeStep(data, len, step)) {
+            return;
+          }
+          if (!queue.add(step)) {
+            Serial.println("Push: queue full, dropped a step.");
+          }
+        });
+#endif
+
+    stepFilter["Expression"] = true;
+    stepFilter["BuzzerDuration"] = true;
+    stepFilter["Sound"] = true;
+    stepFilter["Text"] = true;
+    stepFilter["DisplayDuration"] = true;
+
+    stepStream.onElementComplete([this](const char *json, size_t len) {
+      SequenceStep step;
+      if (decodeStep(json, len, step)) {
+        staging.add(step);
+      }
+    });
+
+    binaryStream.onStepComplete(
+        [this](const StepRecord &record) { addStep(record); });
+
+    request.onHeaderReceived([this](const char *name, const char *value) {
+      if (strcasecmp(name, "Content-Type") == 0) {
+        binaryResponse = strncmp(value, STEP_WIRE_CONTENT_TYPE,
+                                 strlen(STEP_WIRE_CONTENT_TYPE)) == 0;
+      } else if (strcasecmp(name, "ETag") == 0 && strlen(value) <= ETAG_MAX) {
+        strcpy(pendingEtag, value);
+      }
+#if API_COMPRESSION
+      else if (strcasecmp(name, "Content-Encoding") == 0) {
+        bool gzip = strcasecmp(value, "gzip") == 0 ||
+                    strcasecmp(value, "x-gzip") == 0;
+        inflater.begin(gzip ? StreamInflater::FORMAT_GZIP
+                            : StreamInflater::FORMAT_DEFLATE);
+        compressedResponse = gzip || strcasecmp(value, "deflate") == 0;
+      }
+#endif
+    });
+
+    // Parse straight off the socket; error bodies are not sequences
+    request.onBodyData([this](const uint8_t *data, size_t len) {
+      if (request.getStatusCode() != 200) {
+        return true;
+      }
+#if API_COMPRESSION
+      if (compressedResponse) {
+        if (!inflater.feed(data, len)) {
+          Serial.printf("Inflate failed: %s\n", inflater.getError());
+          if (inflater.isWindowExceeded()) {
+            offerCompression = false;
+            refetchPlain = true;
+          }
+          return false;
+        }
+        return true;
+      }
+#endif
+      return decodeBody(data, len);
+    });
+  }
 
   void setStatusCallback(StatusCallback cb) { statusCallback = cb; }
+  void setBatchCallback(BatchCallback cb) { batchCallback = cb; }
+  void setBootTimeline(BootTimeline *t) { timeline = t; }
 
+  // Serial must already be started (main.cpp does it first in setup())
   void begin() {
-    Serial.begin(115200);
     connectWiFi();
   }
 
-  String getBootStatus() { return bootStatus; }
+  const char *getBootStatus() const { return bootStatus; }
 
   bool isBootComplete() { return initialFetchDone; }
 
   void update() {
+    PROFILE_SCOPE(PROF_API_UPDATE);
     unsigned long now = millis();
 
-    // Ensure WiFi is connected
     // Ensure WiFi is connected
     if (WiFi.status() != WL_CONNECTED) {
       if (isConnected) {
         updateStatus("WiFi Lost!");
         isConnected = false;
+        connectWiFi(); // Rejoin the same AP without a scan
+      }
+      wifi.update(now);
+      if (fetchInFlight) {
+        abortFetch();
       }
+#if API_PUSH
+      stopPush();
+#endif
       return;
     } else {
       if (!isConnected) {
         isConnected = true;
-        updateStatus("IP: " + WiFi.localIP().toString());
+        updateStatusIp("IP: ", "");
+        wifi.remember();
+        if (timeline) {
+          timeline->mark(BootTimeline::WIFI_UP,
+                         wifi.usedFastPath() ? "fast" : "scan");
+        }
       }
     }
 
@@ -183,19 +709,32 @@ public:
         if (now - lastCheckTime > 1000) {
           updateStatus("connecting to API..");
           bootState = 2;
+          nextBootAttempt = now;
         }
       } else if (bootState == 2) {
-        // Trigger Fetch
-        if (fetchSequences(MSG_BOOT)) {
-          updateStatus("Connected to API!");
-          bootState = 3;
-          lastCheckTime = millis();
+        if (!tlsConfigured && needsTls()) {
+          // Blocks for the MFLN probe, once, while the boot status (drawn
+          // last frame) is on screen and before any request is in flight
+          configureTls();
+          return;
+        }
+        // Fetch, retrying after a pause while the error stays on screen
+        if (!fetchInFlight) {
+          if ((long)(now - nextBootAttempt) >= 0 && !startFetch(MSG_BOOT)) {
+            nextBootAttempt = now + BOOT_RETRY_DELAY;
+          }
         } else {
-          // Stay in this state but wait a bit before retrying
-          // The updateStatus inside fetchSequences will show the error
-          // We can add a delay here or just rely on the next loop
-          delay(2000); // Wait 2s before retry so user can read error
-          lastCheckTime = millis();
+          FetchResult result = pollFetch();
+          if (result == FETCH_OK) {
+            if (timeline) {
+              timeline->mark(BootTimeline::FIRST_FETCH);
+            }
+            updateStatus("Connected to API!");
+            bootState = 3;
+            lastCheckTime = millis();
+          } else if (result == FETCH_FAILED) {
+            nextBootAttempt = millis() + BOOT_RETRY_DELAY;
+          }
         }
       } else if (bootState == 3) {
         // Wait 1 second to show "Connected to API!"
@@ -206,13 +745,25 @@ public:
       return;
     }
 
-    // 2. Regular Fetch
-    if (now - lastCheckTime >= checkInterval) {
-      // Only fetch if queue is low
-      if (queue.size() < 5) {
-        Serial.println("Queue low, fetching more...");
-        fetchSequences(MSG_REPEAT);
-      }
+    // 2. Push stream (steps arrive as the server sends them)
+    bool pushing = false;
+#if API_PUSH
+    updatePush(now);
+    pushing = pushLive;
+#endif
+
+    // 3. Regular Fetch (fallback while there is no push stream)
+    if (!staging.isEmpty()) {
+      // Leftovers from a batch bigger than the room. Steps of a response
+      // still in flight are not released yet and stay put.
+      staging.commitTo(queue);
+    }
+    if (fetchInFlight) {
+      pollFetch();
+    } else if (!pushing && needsRefill(now)) {
+      Serial.printf("Queue has %lums left, fetching more...\n",
+                    (unsigned long)queue.remainingMs(now));
+      startFetch(MSG_REPEAT);
       lastCheckTime = now;
     }
   }
@@ -0,0 +1,432 @@
+#ifndef ASYNCHTTPREQUEST_H
+#define ASYNCHTTPREQUEST_H
+
+#include "HttpUrl.h"
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <functional>
+
+// Time and size budget for a single poll()
+#define HTTP_POLL_BUDGET_US 3000
+#define HTTP_READ_CHUNK 128
+
+#define HTTP_CONNECT_TIMEOUT_MS 3000
+#define HTTP_TIMEOUT_MS 10000 // Without receiving anything
+#define HTTP_LINE_MAX 160
+// Request line + headers + body, built in place (no heap)
+#define HTTP_REQUEST_MAX 640
+
+// How long a resolved API host address is reused before asking DNS again
+#define HTTP_DNS_TTL_MS 600000UL
+
+// Minimal HTTP/1.1 client that never waits for the network. poll() does a
+// bounded slice of work (send what fits, read what has arrived) and
+// returns, so the caller's render loop keeps running while a request is in
+// flight. Body bytes are handed to a callback as they arrive, with chunked
+// transfer encoding already removed.
+//
+// The one step that can still block is connect(): the ESP8266 core does
+// DNS, the TCP handshake and (for BearSSL) the TLS handshake in one call.
+// It gets a short timeout of its own, and is skipped entirely when the
+// previous response left a keep-alive connection open. Plain HTTP also
+// reuses the resolved address instead of asking DNS every time.
+class AsyncHttpRequest {
+public:
+  enum State {
+    STATE_IDLE,
+    STATE_CONNECTING,
+    STATE_SENDING,
+    STATE_READING_STATUS,
+    STATE_READING_HEADERS,
+    STATE_READING_BODY,
+    STATE_DONE,
+    STATE_FAILED
+  };
+
+  using HeaderHandler =
+      std::function<void(const char *name, const char *value)>;
+  // Return false to abort the request
+  using BodyHandler = std::function<bool(const uint8_t *data, size_t len)>;
+
+private:
+  enum ChunkState { CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER };
+
+  WiFiClient *client;
+  HttpUrl url;
+  char outgoing[HTTP_REQUEST_MAX]; // Request head + body
+  size_t outgoingLength;
+  size_t sent;
+
+  State state;
+  const char *error;
+  unsigned long lastActivity; // Start, or the last bytes received
+  unsigned long timeoutMs;
+
+  // Connection reuse
+  bool keepAlive;        // Ask the server to keep the socket open
+  bool serverKeepsAlive; // ...and it agreed
+  bool reused;           // This request went out on an open socket
+  bool retried;          // Already reconnected once after a stale socket
+
+  // DNS cache (plain HTTP only: TLS needs the name for SNI)
+  String resolvedHost;
+  IPAddress resolvedIP;
+  unsigned long resolvedAt;
+
+  int statusCode;
+  long contentLength; // -1 = unknown (read until close)
+  long bodyReceived;
+  bool chunked;
+  ChunkState chunkState;
+  long chunkRemaining;
+
+  char line[HTTP_LINE_MAX];
+  int lineLen;
+
+  HeaderHandler onHeader;
+  BodyHandler onBody;
+
+  void fail(const char *why) {
+    error = why;
+    state = STATE_FAILED;
+    if (client)
+      client->stop();
+  }
+
+  void finish() {
+    state = STATE_DONE;
+    // A body delimited by the close can't leave a usable socket behind
+    bool reusable = keepAlive && serverKeepsAlive &&
+                    (chunked || contentLength >= 0);
+    if (client && !reusable)
+      client->stop();
+  }
+
+  bool openConnection() {
+    if (client->connected()) {
+      reused = true;
+      return true;
+    }
+    reused = false;
+    client->stop();
+    client->setTimeout(HTTP_CONNECT_TIMEOUT_MS);
+
+    if (url.secure) {
+      return client->connect(url.host.c_str(), url.port);
+    }
+
+    if (resolvedHost != url.host || millis() - resolvedAt > HTTP_DNS_TTL_MS) {
+      if (!WiFi.hostByName(url.host.c_str(), resolvedIP)) {
+        return false;
+      }
+      resolvedHost = url.host;
+      resolvedAt = millis();
+    }
+    if (client->connect(resolvedIP, url.port)) {
+      return true;
+    }
+    resolvedHost = ""; // The address may have moved: resolve next time
+    return false;
+  }
+
+  // The server may close an idle keep-alive socket just as we reuse it.
+  // Nothing was answered yet, so it's safe to send again once.
+  bool retryStaleConnection() {
+    if (!reused || retried || state == STATE_READING_HEADERS ||
+        state == STATE_READING_BODY || lineLen > 0)
+      return false;
+    retried = true;
+    client->stop();
+    sent = 0;
+    state = STATE_CONNECTING;
+    return true;
+  }
+
+  // Collects one CRLF-terminated line. Returns true when complete.
+  bool takeLineByte(char c) {
+    if (c == '\n') {
+      if (lineLen > 0 && line[lineLen - 1] == '\r')
+        lineLen--;
+      line[lineLen] = '\0';
+      return true;
+    }
+    if (lineLen < HTTP_LINE_MAX - 1)
+      line[lineLen++] = c;
+    return false;
+  }
+
+  void handleStatusLine() {
+    // "HTTP/1.1 200 OK"
+    const char *space = strchr(line, ' ');
+    statusCode = space ? atoi(space + 1) : 0;
+    if (statusCode <= 0) {
+      fail("Bad status line");
+      return;
+    }
+    // HTTP/1.0 closes unless told otherwise; assume it will
+    serverKeepsAlive = strncmp(line, "HTTP/1.0", 8) != 0;
+    state = STATE_READING_HEADERS;
+  }
+
+  void handleHeaderLine() {
+    if (lineLen == 0) {
+      // End of headers
+      bool noBody = statusCode == 204 || statusCode == 304 ||
+                    (statusCode >= 100 && statusCode < 200);
+      if (noBody || (!chunked && contentLength == 0)) {
+        finish();
+      } else {
+        state = STATE_READING_BODY;
+        chunkState = CHUNK_SIZE;
+      }
+      return;
+    }
+
+    char *colon = strchr(line, ':');
+    if (!colon)
+      return;
+    *colon = '\0';
+    const char *value = colon + 1;
+    while (*value == ' ')
+      value++;
+
+    if (strcasecmp(line, "Content-Length") == 0) {
+      contentLength = atol(value);
+    } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+      chunked = strstr(value, "chunked") != nullptr;
+    } else if (strcasecmp(line, "Connection") == 0) {
+      serverKeepsAlive = strcasecmp(value, "close") != 0;
+    }
+    if (onHeader)
+      onHeader(line, value);
+  }
+
+  bool deliver(const uint8_t *data, size_t len) {
+    bodyReceived += len;
+    if (onBody && !onBody(data, len)) {
+      fail("Body rejected");
+      return false;
+    }
+    return true;
+  }
+
+  // Body bytes, still chunk-encoded if chunked
+  void consumeBody(const uint8_t *data, size_t len) {
+    if (!chunked) {
+      if (contentLength >= 0 && bodyReceived + (long)len > contentLength)
+        len = contentLength - bodyReceived;
+      if (!deliver(data, len))
+        return;
+      if (contentLength >= 0 && bodyReceived >= contentLength)
+        finish();
+      return;
+    }
+
+    size_t i = 0;
+    while (i < len && state == STATE_READING_BODY) {
+      switch (chunkState) {
+      case CHUNK_SIZE:
+        if (takeLineByte((char)data[i++])) {
+          chunkRemaining = strtol(line, nullptr, 16);
+          lineLen = 0;
+          chunkState = chunkRemaining > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+        }
+        break;
+
+      case CHUNK_DATA: {
+        size_t n = len - i;
+        if ((long)n > chunkRemaining)
+          n = chunkRemaining;
+        if (!deliver(data + i, n))
+          return;
+        i += n;
+        chunkRemaining -= n;
+        if (chunkRemaining == 0)
+          chunkState = CHUNK_DATA_END;
+        break;
+      }
+
+      case CHUNK_DATA_END: // CRLF after the data
+        if (takeLineByte((char)data[i++])) {
+          lineLen = 0;
+          chunkState = CHUNK_SIZE;
+        }
+        break;
+
+      case CHUNK_TRAILER: // Trailer headers, ended by an empty line
+        if (takeLineByte((char)data[i++])) {
+          bool last = lineLen == 0;
+          lineLen = 0;
+          if (last)
+            finish();
+        }
+        break;
+      }
+    }
+  }
+
+  void consume(const uint8_t *data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+      if (state == STATE_READING_STATUS || state == STATE_READING_HEADERS) {
+        if (takeLineByte((char)data[i++])) {
+          if (state == STATE_READING_STATUS)
+            handleStatusLine();
+          else
+            handleHeaderLine();
+          lineLen = 0;
+        }
+      } else if (state == STATE_READING_BODY) {
+        consumeBody(data + i, len - i);
+        return;
+      } else {
+        return; // Done or failed: ignore the rest
+      }
+    }
+  }
+
+public:
+  AsyncHttpRequest()
+      : client(nullptr), outgoingLength(0), sent(0), state(STATE_IDLE),
+        error(nullptr), lastActivity(0), timeoutMs(HTTP_TIMEOUT_MS),
+        keepAlive(true), serverKeepsAlive(false), reused(false),
+        retried(false), resolvedAt(0), statusCode(0), contentLength(-1),
+        bodyReceived(0), chunked(false), chunkState(CHUNK_SIZE),
+        chunkRemaining(0), lineLen(0) {}
+
+  void onHeaderReceived(HeaderHandler handler) { onHeader = handler; }
+  void onBodyData(BodyHandler handler) { onBody = handler; }
+
+  // Keep the socket open between requests (HTTP/1.1 keep-alive)
+  void setKeepAlive(bool enabled) { keepAlive = enabled; }
+
+  // Give up after this long without receiving anything. Long-lived
+  // streams raise it above the server's heartbeat interval.
+  void setTimeout(unsigned long ms) { timeoutMs = ms; }
+
+  // Queue a request. Nothing touches the network until the next poll().
+  void start(const char *method, WiFiClient &c, const HttpUrl &target,
+             const char *body, const char *extraHeaders) {
+    client = &c;
+    url = target;
+
+    int n = snprintf(outgoing, sizeof(outgoing),
+                     "%s %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n",
+                     method, url.path.c_str(), url.host.c_str(),
+                     keepAlive ? "keep-alive" : "close");
+    if (n >= 0 && (size_t)n < sizeof(outgoing) && strcmp(method, "GET")) {
+      n += snprintf(outgoing + n, sizeof(outgoing) - n,
+                    "Content-Length: %u\r\n", (unsigned)strlen(body));
+    }
+    if (n >= 0 && (size_t)n < sizeof(outgoing)) {
+      n += snprintf(outgoing + n, sizeof(outgoing) - n, "%s\r\n%s",
+                    extraHeaders, body);
+    }
+    outgoingLength = n;
+    sent = 0;
+
+    state = STATE_CONNECTING;
+    error = nullptr;
+    lastActivity = millis();
+    serverKeepsAlive = false;
+    reused = false;
+    retried = false;
+    statusCode = 0;
+    contentLength = -1;
+    bodyReceived = 0;
+    chunked = false;
+    lineLen = 0;
+
+    if (n < 0 || (size_t)n >= sizeof(outgoing)) {
+      fail("Request too large");
+    }
+  }
+
+  void startPost(WiFiClient &c, const HttpUrl &target, const char *body,
+                 const char *extraHeaders) {
+    start("POST", c, target, body, extraHeaders);
+  }
+
+  void startGet(WiFiClient &c, const HttpUrl &target,
+                const char *extraHeaders) {
+    start("GET", c, target, "", extraHeaders);
+  }
+
+  void abort() {
+    if (isBusy())
+      fail("Aborted");
+  }
+
+  State getState() const { return state; }
+  bool isBusy() const { return state != STATE_IDLE && state != STATE_DONE &&
+                               state != STATE_FAILED; }
+  int getStatusCode() const { return statusCode; }
+  const char *getError() const { return error ? error : ""; }
+  long getBodyReceived() const { return bodyReceived; }
+  bool wasReused() const { return reused; }
+
+  // Do a bounded slice of work. Call every loop until DONE or FAILED.
+  State poll() {
+    if (!isBusy())
+      return state;
+
+    if (millis() - lastActivity > timeoutMs) {
+      fail("Timeout");
+      return state;
+    }
+
+    switch (state) {
+    case STATE_CONNECTING:
+      if (openConnection()) {
+        state = STATE_SENDING;
+      } else {
+        fail("Conn Failed!");
+      }
+      break;
+
+    case STATE_SENDING: {
+      // Only write what the TCP window takes right now
+      size_t room = client->availableForWrite();
+      size_t left = outgoingLength - sent;
+      size_t n = room < left ? room : left;
+      if (n > 0) {
+        sent += client->write((const uint8_t *)outgoing + sent, n);
+      }
+      if (sent >= outgoingLength) {
+        state = STATE_READING_STATUS;
+      } else if (!client->connected() && !retryStaleConnection()) {
+        fail("Send failed");
+      }
+      break;
+    }
+
+    default: {
+      uint8_t buf[HTTP_READ_CHUNK];
+      unsigned long sliceStart = micros();
+      while (isBusy() && micros() - sliceStart < HTTP_POLL_BUDGET_US) {
+        int avail = client->available();
+        if (avail <= 0)
+          break;
+        int n =
+            client->read(buf, avail < (int)sizeof(buf) ? avail : sizeof(buf));
+        if (n <= 0)
+          break;
+        lastActivity = millis();
+        consume(buf, n);
+      }
+
+      if (isBusy() && !client->connected() && client->available() <= 0) {
+        // Server closed: fine only for a body without a length
+        if (state == STATE_READING_BODY && !chunked && contentLength < 0)
+          finish();
+        else if (!retryStaleConnection())
+          fail("Connection closed");
+      }
+      break;
+    }
+    }
+    return state;
+  }
+};
+
+#endif
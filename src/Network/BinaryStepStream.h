@@ -0,0 +1,156 @@
+#ifndef BINARYSTEPSTREAM_H
+#define BINARYSTEPSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+// Content type of the packed step format, offered in the Accept header
+#define STEP_WIRE_CONTENT_TYPE "application/x-jumbo-steps"
+#define STEP_WIRE_VERSION 2 // Written by us; version 1 is still read
+
+// Packed step format (all integers little-endian):
+//
+//   header: 'J' 'S' <version u8>
+//   step:   <expression u8> <beep ms u16> <sound u8, version 2 only>
+//           <display ms u32> <text length u8> <text bytes, not terminated>
+//
+// Steps follow the header back to back until the body ends. Expression is
+// the Eye::Expression value (0 angry, 1 happy, 2 shocked, 3 sad, 4 calm,
+// 5 sleep), sound a SoundPatternId (0 = just the beep). A step is 9 bytes
+// plus its text, against ~90 bytes of keys and punctuation per step in
+// JSON.
+struct StepRecord {
+  uint8_t expression;
+  uint16_t beepMs;
+  uint8_t soundPattern; // 0 in version 1 bodies
+  uint32_t displayMs;
+  uint8_t textLength;
+  char text[256]; // Always null-terminated
+};
+
+// Decodes the packed format as the bytes arrive, in any split
+class BinaryStepStream {
+public:
+  using StepHandler = std::function<void(const StepRecord &step)>;
+
+private:
+  enum Field {
+    HEADER,
+    EXPRESSION,
+    BEEP,
+    SOUND,
+    DISPLAY,
+    TEXT_LENGTH,
+    TEXT,
+    MALFORMED
+  };
+
+  Field field;
+  int fieldPos; // Bytes of the current field read so far
+  uint8_t version;
+  StepRecord record;
+  int emitted;
+  StepHandler onStep;
+
+  void emit() {
+    record.text[record.textLength] = '\0';
+    emitted++;
+    if (onStep)
+      onStep(record);
+    field = EXPRESSION;
+  }
+
+public:
+  BinaryStepStream() { reset(); }
+
+  void onStepComplete(StepHandler handler) { onStep = handler; }
+
+  void reset() {
+    field = HEADER;
+    fieldPos = 0;
+    version = 0;
+    emitted = 0;
+  }
+
+  void feed(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len && field != MALFORMED; i++) {
+      uint8_t b = data[i];
+
+      switch (field) {
+      case HEADER:
+        if (fieldPos == 2) {
+          version = b;
+          field = b >= 1 && b <= STEP_WIRE_VERSION ? EXPRESSION : MALFORMED;
+        } else if (b != (fieldPos == 0 ? 'J' : 'S')) {
+          field = MALFORMED;
+        } else {
+          fieldPos++;
+        }
+        break;
+
+      case EXPRESSION:
+        record.expression = b;
+        record.beepMs = 0;
+        record.soundPattern = 0;
+        record.displayMs = 0;
+        field = BEEP;
+        fieldPos = 0;
+        break;
+
+      case BEEP:
+        record.beepMs |= (uint16_t)b << (8 * fieldPos);
+        if (++fieldPos == 2) {
+          field = version >= 2 ? SOUND : DISPLAY;
+          fieldPos = 0;
+        }
+        break;
+
+      case SOUND:
+        record.soundPattern = b;
+        field = DISPLAY;
+        break;
+
+      case DISPLAY:
+        record.displayMs |= (uint32_t)b << (8 * fieldPos);
+        if (++fieldPos == 4)
+          field = TEXT_LENGTH;
+        break;
+
+      case TEXT_LENGTH:
+        record.textLength = b;
+        fieldPos = 0;
+        if (b == 0)
+          emit();
+        else
+          field = TEXT;
+        break;
+
+      case TEXT: {
+        // Copy as much of the text as this chunk holds
+        size_t n = len - i;
+        size_t want = record.textLength - fieldPos;
+        if (n > want)
+          n = want;
+        for (size_t k = 0; k < n; k++)
+          record.text[fieldPos + k] = (char)data[i + k];
+        fieldPos += n;
+        i += n - 1;
+        if (fieldPos == record.textLength)
+          emit();
+        break;
+      }
+
+      case MALFORMED:
+        break;
+      }
+    }
+  }
+
+  // True when the body so far ends exactly on a step boundary
+  bool isComplete() const { return field == EXPRESSION; }
+  bool isMalformed() const { return field == MALFORMED; }
+  int getEmitted() const { return emitted; }
+};
+
+#endif
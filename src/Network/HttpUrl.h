@@ -0,0 +1,46 @@
+#ifndef HTTPURL_H
+#define HTTPURL_H
+
+#include <Arduino.h>
+
+// Split of an http(s)://host[:port]/path URL, parsed once at startup
+struct HttpUrl {
+  bool secure;
+  String host;
+  uint16_t port;
+  String path;
+
+  HttpUrl() : secure(false), port(80), path("/") {}
+
+  bool parse(const char *url) {
+    String s(url);
+    int start;
+    if (s.startsWith("https://")) {
+      secure = true;
+      port = 443;
+      start = 8;
+    } else if (s.startsWith("http://")) {
+      secure = false;
+      port = 80;
+      start = 7;
+    } else {
+      return false;
+    }
+
+    int slash = s.indexOf('/', start);
+    String authority =
+        slash < 0 ? s.substring(start) : s.substring(start, slash);
+    path = slash < 0 ? String("/") : s.substring(slash);
+
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+      host = authority.substring(0, colon);
+      port = (uint16_t)authority.substring(colon + 1).toInt();
+    } else {
+      host = authority;
+    }
+    return host.length() > 0 && port != 0;
+  }
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef JSONARRAYSTREAM_H
+#define JSONARRAYSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+// Largest single array element we keep; bigger ones are skipped
+#define JSON_ELEMENT_MAX 384
+
+// Splits a top-level JSON array into its elements as the bytes arrive:
+//   [{...}, {...}, ...]
+// Each complete object (or nested array) is handed to the callback as its
+// own small JSON document, so memory stays at one element no matter how
+// long the array is. Scalars at the top level are ignored.
+class JsonArrayStream {
+public:
+  using ElementHandler = std::function<void(const char *json, size_t len)>;
+
+private:
+  enum Phase { BEFORE_ARRAY, IN_ARRAY, IN_ELEMENT, AFTER_ARRAY, MALFORMED };
+
+  char element[JSON_ELEMENT_MAX];
+  size_t length;
+  bool overflow;
+
+  Phase phase;
+  int depth; // Nesting inside the current element
+  bool inString;
+  bool escaped;
+
+  int emitted;
+  int skipped;
+  ElementHandler onElement;
+
+  void append(char c) {
+    if (length < JSON_ELEMENT_MAX)
+      element[length++] = c;
+    else
+      overflow = true;
+  }
+
+  void endElement() {
+    if (overflow) {
+      skipped++;
+    } else {
+      emitted++;
+      if (onElement)
+        onElement(element, length);
+    }
+    length = 0;
+    overflow = false;
+    phase = IN_ARRAY;
+  }
+
+public:
+  JsonArrayStream() { reset(); }
+
+  void onElementComplete(ElementHandler handler) { onElement = handler; }
+
+  void reset() {
+    length = 0;
+    overflow = false;
+    phase = BEFORE_ARRAY;
+    depth = 0;
+    inString = false;
+    escaped = false;
+    emitted = 0;
+    skipped = 0;
+  }
+
+  void feed(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      char c = (char)data[i];
+
+      switch (phase) {
+      case BEFORE_ARRAY:
+        if (c == '[')
+          phase = IN_ARRAY;
+        else if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+          phase = MALFORMED;
+        break;
+
+      case IN_ARRAY:
+        if (c == '{' || c == '[') {
+          phase = IN_ELEMENT;
+          depth = 1;
+          inString = false;
+          escaped = false;
+          append(c);
+        } else if (c == ']') {
+          phase = AFTER_ARRAY;
+        }
+        break;
+
+      case IN_ELEMENT:
+        append(c);
+        if (inString) {
+          if (escaped)
+            escaped = false;
+          else if (c == '\\')
+            escaped = true;
+          else if (c == '"')
+            inString = false;
+        } else if (c == '"') {
+          inString = true;
+        } else if (c == '{' || c == '[') {
+          depth++;
+        } else if (c == '}' || c == ']') {
+          if (--depth == 0)
+            endElement();
+        }
+        break;
+
+      case AFTER_ARRAY:
+      case MALFORMED:
+        return;
+      }
+    }
+  }
+
+  // True once the closing ']' has been seen
+  bool isComplete() const { return phase == AFTER_ARRAY; }
+  bool isMalformed() const { return phase == MALFORMED; }
+  int getEmitted() const { return emitted; }
+  int getSkipped() const { return skipped; }
+};
+
+#endif
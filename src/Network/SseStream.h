@@ -0,0 +1,137 @@
+#ifndef SSESTREAM_H
+#define SSESTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <functional>
+
+// Longest "data:" payload per event; longer events are dropped
+#define SSE_DATA_MAX 384
+#define SSE_LINE_MAX (SSE_DATA_MAX + 8)
+
+// Server-Sent Events parser (text/event-stream), fed as bytes arrive:
+//
+//   event: step
+//   data: {"Expression": "happy", ...}
+//
+// A blank line ends an event. Comment lines (": ping") are heartbeats and
+// only keep the connection from timing out. Multi-line data is joined with
+// '\n' as the spec says; "id:" and "retry:" are ignored.
+class SseStream {
+public:
+  using EventHandler =
+      std::function<void(const char *event, const char *data, size_t len)>;
+
+private:
+  char line[SSE_LINE_MAX];
+  size_t lineLength;
+  bool lineOverflow;
+
+  char eventName[24];
+  char data[SSE_DATA_MAX + 1];
+  size_t dataLength;
+  bool dataOverflow;
+
+  int dispatched;
+  int dropped;
+  EventHandler onEvent;
+
+  void clearEvent() {
+    eventName[0] = '\0';
+    dataLength = 0;
+    dataOverflow = false;
+  }
+
+  void dispatch() {
+    if (dataOverflow) {
+      dropped++;
+    } else if (dataLength > 0) {
+      data[dataLength] = '\0';
+      dispatched++;
+      if (onEvent)
+        onEvent(eventName[0] ? eventName : "message", data, dataLength);
+    }
+    clearEvent();
+  }
+
+  void appendData(const char *value, size_t len) {
+    size_t needed = len + (dataLength > 0 ? 1 : 0);
+    if (dataLength + needed > SSE_DATA_MAX) {
+      dataOverflow = true;
+      return;
+    }
+    if (dataLength > 0)
+      data[dataLength++] = '\n';
+    memcpy(data + dataLength, value, len);
+    dataLength += len;
+  }
+
+  void processLine() {
+    if (lineLength == 0) {
+      dispatch();
+      return;
+    }
+    if (line[0] == ':')
+      return; // Comment / heartbeat
+
+    if (lineOverflow) {
+      dataOverflow = true; // Can't trust a cut line
+      return;
+    }
+
+    line[lineLength] = '\0';
+    char *value = strchr(line, ':');
+    size_t valueLength = 0;
+    if (value) {
+      *value++ = '\0';
+      if (*value == ' ')
+        value++;
+      valueLength = lineLength - (value - line);
+    } else {
+      value = line + lineLength; // Field with an empty value
+    }
+
+    if (strcmp(line, "data") == 0) {
+      appendData(value, valueLength);
+    } else if (strcmp(line, "event") == 0) {
+      strncpy(eventName, value, sizeof(eventName) - 1);
+      eventName[sizeof(eventName) - 1] = '\0';
+    }
+  }
+
+public:
+  SseStream() { reset(); }
+
+  void onEventReceived(EventHandler handler) { onEvent = handler; }
+
+  void reset() {
+    lineLength = 0;
+    lineOverflow = false;
+    dispatched = 0;
+    dropped = 0;
+    clearEvent();
+  }
+
+  void feed(const uint8_t *bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      char c = (char)bytes[i];
+      if (c == '\r')
+        continue; // Accept both CRLF and LF line ends
+      if (c == '\n') {
+        processLine();
+        lineLength = 0;
+        lineOverflow = false;
+      } else if (lineLength < SSE_LINE_MAX - 1) {
+        line[lineLength++] = c;
+      } else {
+        lineOverflow = true;
+      }
+    }
+  }
+
+  int getDispatched() const { return dispatched; }
+  int getDropped() const { return dropped; }
+};
+
+#endif
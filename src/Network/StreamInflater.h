@@ -0,0 +1,538 @@
+#ifndef STREAMINFLATER_H
+#define STREAMINFLATER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <functional>
+
+// History kept for back-references: 2^12 = 4 KB. A match can never reach
+// further back than the output so far, so any compressor works for bodies
+// up to this size; for longer bodies the server must compress with a
+// window no larger than this (zlib wbits <= 12).
+#define INFLATE_WINDOW_BITS 12
+#define INFLATE_WINDOW_SIZE (1 << INFLATE_WINDOW_BITS)
+
+// Compressed bytes buffered while waiting for a complete unit (one
+// symbol, or a whole block header: a dynamic one is at most ~290 bytes)
+#define INFLATE_INPUT_MAX 512
+// Decompressed bytes handed downstream at once
+#define INFLATE_OUTPUT_CHUNK 64
+
+// Resumable DEFLATE decoder (RFC 1951) for gzip (RFC 1952) and zlib
+// (RFC 1950) bodies, fed as the compressed bytes arrive.
+//
+// Decoding goes in small units: a block header, a stored byte, or one
+// literal / length-distance pair. If a unit runs out of input halfway, the
+// bit position is rolled back and the unit is retried on the next feed(),
+// so there is no per-bit suspend state. Memory is fixed: the window, the
+// input buffer and two Huffman tables, about 5.5 KB in total.
+//
+// Checksums (CRC32 / Adler-32) are skipped: TCP already covers transport
+// errors, and the JSON and binary step parsers reject malformed output.
+class StreamInflater {
+public:
+  enum Format { FORMAT_GZIP, FORMAT_DEFLATE }; // DEFLATE: zlib or raw
+  using OutputHandler = std::function<bool(const uint8_t *data, size_t len)>;
+
+private:
+  enum Phase {
+    PHASE_WRAPPER_HEADER,
+    PHASE_BLOCK_HEADER,
+    PHASE_STORED,
+    PHASE_HUFFMAN,
+    PHASE_WRAPPER_TRAILER,
+    PHASE_FINISHED,
+    PHASE_FAILED
+  };
+  enum Unit { UNIT_DONE, UNIT_NEED_INPUT, UNIT_ERROR };
+  enum Wrapper { WRAP_GZIP, WRAP_ZLIB, WRAP_RAW };
+
+  // Canonical Huffman code: number of codes per length, then the symbols
+  // ordered by code
+  struct Huffman {
+    uint16_t counts[16];
+    uint16_t symbols[288];
+  };
+
+  struct BitPosition {
+    size_t pos;
+    uint32_t bitBuf;
+    int bitCount;
+  };
+
+  uint8_t input[INFLATE_INPUT_MAX];
+  size_t inLen;
+  size_t inPos;
+  uint32_t bitBuf;
+  int bitCount;
+
+  uint8_t window[INFLATE_WINDOW_SIZE];
+  uint32_t totalOut;
+  uint8_t out[INFLATE_OUTPUT_CHUNK];
+  size_t outLen;
+
+  Huffman literals;
+  Huffman distances;
+
+  Format format;
+  Wrapper wrapper;
+  Phase phase;
+  bool lastBlock;
+  uint16_t storedLeft;
+  const char *error;
+  bool windowExceeded; // Back-reference past our window, not past the start
+  OutputHandler onOutput;
+
+  // ---- Bit input --------------------------------------------------------
+
+  BitPosition mark() const { return {inPos, bitBuf, bitCount}; }
+
+  void rewind(const BitPosition &p) {
+    inPos = p.pos;
+    bitBuf = p.bitBuf;
+    bitCount = p.bitCount;
+  }
+
+  // n <= 16
+  bool bits(int n, uint32_t &value) {
+    while (bitCount < n) {
+      if (inPos >= inLen)
+        return false;
+      bitBuf |= (uint32_t)input[inPos++] << bitCount;
+      bitCount += 8;
+    }
+    value = bitBuf & ((1UL << n) - 1);
+    bitBuf >>= n;
+    bitCount -= n;
+    return true;
+  }
+
+  void alignToByte() {
+    bitBuf >>= bitCount & 7;
+    bitCount -= bitCount & 7;
+  }
+
+  // ---- Huffman ----------------------------------------------------------
+
+  // Returns false for an over-subscribed code. Incomplete codes are
+  // allowed (a single distance code is legal).
+  static bool build(Huffman &h, const uint8_t *lengths, int n) {
+    memset(h.counts, 0, sizeof(h.counts));
+    for (int i = 0; i < n; i++)
+      h.counts[lengths[i]]++;
+    h.counts[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+      left = (left << 1) - h.counts[len];
+      if (left < 0)
+        return false;
+    }
+
+    uint16_t offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 15; len++)
+      offsets[len + 1] = offsets[len] + h.counts[len];
+    for (int i = 0; i < n; i++) {
+      if (lengths[i])
+        h.symbols[offsets[lengths[i]]++] = i;
+    }
+    return true;
+  }
+
+  // Symbol, or -1 when out of input, -2 for an invalid code
+  int decode(const Huffman &h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; len++) {
+      uint32_t bit;
+      if (!bits(1, bit))
+        return -1;
+      code |= bit;
+      int count = h.counts[len];
+      if (code - count < first)
+        return h.symbols[index + (code - first)];
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    return -2;
+  }
+
+  // ---- Output -----------------------------------------------------------
+
+  bool flushOutput() {
+    if (outLen > 0 && onOutput && !onOutput(out, outLen)) {
+      outLen = 0;
+      return fail("Output rejected");
+    }
+    outLen = 0;
+    return true;
+  }
+
+  bool put(uint8_t b) {
+    window[totalOut & (INFLATE_WINDOW_SIZE - 1)] = b;
+    totalOut++;
+    out[outLen++] = b;
+    return outLen < INFLATE_OUTPUT_CHUNK || flushOutput();
+  }
+
+  bool fail(const char *why) {
+    error = why;
+    phase = PHASE_FAILED;
+    return false;
+  }
+
+  // ---- Units ------------------------------------------------------------
+
+  Unit wrapperHeader() {
+    uint32_t b0, b1;
+    if (format == FORMAT_DEFLATE) {
+      // zlib header if it checks out, otherwise raw deflate
+      if (!bits(8, b0) || !bits(8, b1))
+        return UNIT_NEED_INPUT;
+      if ((b0 & 0x0F) == 8 && (b0 >> 4) <= 7 && ((b0 << 8) | b1) % 31 == 0) {
+        if (b1 & 0x20) {
+          fail("Preset dictionary");
+          return UNIT_ERROR;
+        }
+        wrapper = WRAP_ZLIB;
+      } else {
+        inPos = 0; // Raw: those were data bits
+        bitBuf = 0;
+        bitCount = 0;
+        wrapper = WRAP_RAW;
+      }
+      return UNIT_DONE;
+    }
+
+    uint32_t method, flags, skip;
+    if (!bits(8, b0) || !bits(8, b1) || !bits(8, method) || !bits(8, flags) ||
+        !bits(16, skip) || !bits(16, skip) || !bits(16, skip)) // MTIME XFL OS
+      return UNIT_NEED_INPUT;
+    if (b0 != 0x1F || b1 != 0x8B || method != 8) {
+      fail("Not gzip");
+      return UNIT_ERROR;
+    }
+    if (flags & 0x04) { // FEXTRA
+      uint32_t xlen, x;
+      if (!bits(16, xlen))
+        return UNIT_NEED_INPUT;
+      while (xlen--) {
+        if (!bits(8, x))
+          return UNIT_NEED_INPUT;
+      }
+    }
+    for (uint32_t flag = 0x08; flag <= 0x10; flag <<= 1) { // FNAME, FCOMMENT
+      if (flags & flag) {
+        uint32_t c;
+        do {
+          if (!bits(8, c))
+            return UNIT_NEED_INPUT;
+        } while (c != 0);
+      }
+    }
+    if ((flags & 0x02) && !bits(16, skip)) // FHCRC
+      return UNIT_NEED_INPUT;
+    wrapper = WRAP_GZIP;
+    return UNIT_DONE;
+  }
+
+  Unit fixedTables() {
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    build(literals, lengths, 288);
+    memset(lengths, 5, 30);
+    build(distances, lengths, 30);
+    return UNIT_DONE;
+  }
+
+  Unit dynamicTables() {
+    static const uint8_t order[19] PROGMEM = {16, 17, 18, 0, 8,  7, 9,
+                                              6,  10, 5,  11, 4, 12, 3,
+                                              13, 2,  14, 1,  15};
+    uint32_t hlit, hdist, hclen;
+    if (!bits(5, hlit) || !bits(5, hdist) || !bits(4, hclen))
+      return UNIT_NEED_INPUT;
+    int nlen = hlit + 257, ndist = hdist + 1, ncode = hclen + 4;
+    if (nlen > 286 || ndist > 30) {
+      fail("Bad table sizes");
+      return UNIT_ERROR;
+    }
+
+    uint8_t lengths[320];
+    memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++) {
+      uint32_t len;
+      if (!bits(3, len))
+        return UNIT_NEED_INPUT;
+      lengths[pgm_read_byte(&order[i])] = len;
+    }
+    // The code-length code borrows the distance table until the real one
+    // is built from what it decodes
+    if (!build(distances, lengths, 19)) {
+      fail("Bad code lengths");
+      return UNIT_ERROR;
+    }
+
+    int index = 0;
+    while (index < nlen + ndist) {
+      int sym = decode(distances);
+      if (sym == -1)
+        return UNIT_NEED_INPUT;
+      if (sym < 0) {
+        fail("Bad code length");
+        return UNIT_ERROR;
+      }
+      if (sym < 16) {
+        lengths[index++] = sym;
+        continue;
+      }
+
+      uint8_t repeatLen = 0;
+      uint32_t extra;
+      int repeat;
+      if (sym == 16) {
+        if (index == 0) {
+          fail("Repeat with no length");
+          return UNIT_ERROR;
+        }
+        repeatLen = lengths[index - 1];
+        if (!bits(2, extra))
+          return UNIT_NEED_INPUT;
+        repeat = 3 + extra;
+      } else if (sym == 17) {
+        if (!bits(3, extra))
+          return UNIT_NEED_INPUT;
+        repeat = 3 + extra;
+      } else {
+        if (!bits(7, extra))
+          return UNIT_NEED_INPUT;
+        repeat = 11 + extra;
+      }
+      if (index + repeat > nlen + ndist) {
+        fail("Too many lengths");
+        return UNIT_ERROR;
+      }
+      while (repeat--)
+        lengths[index++] = repeatLen;
+    }
+
+    if (lengths[256] == 0 || !build(literals, lengths, nlen) ||
+        !build(distances, lengths + nlen, ndist)) {
+      fail("Bad literal/distance code");
+      return UNIT_ERROR;
+    }
+    return UNIT_DONE;
+  }
+
+  Unit blockHeader() {
+    uint32_t final, type;
+    if (!bits(1, final) || !bits(2, type))
+      return UNIT_NEED_INPUT;
+    lastBlock = final;
+
+    if (type == 0) {
+      uint32_t len, nlen;
+      alignToByte();
+      if (!bits(16, len) || !bits(16, nlen))
+        return UNIT_NEED_INPUT;
+      if (len != (~nlen & 0xFFFF)) {
+        fail("Bad stored length");
+        return UNIT_ERROR;
+      }
+      storedLeft = len;
+      phase = PHASE_STORED;
+      return UNIT_DONE;
+    }
+
+    Unit u = type == 1 ? fixedTables()
+             : type == 2 ? dynamicTables()
+                         : (fail("Bad block type"), UNIT_ERROR);
+    if (u == UNIT_DONE)
+      phase = PHASE_HUFFMAN;
+    return u;
+  }
+
+  void endBlock() {
+    phase = lastBlock ? PHASE_WRAPPER_TRAILER : PHASE_BLOCK_HEADER;
+  }
+
+  Unit storedByte() {
+    if (storedLeft == 0) {
+      endBlock();
+      return UNIT_DONE;
+    }
+    uint32_t b;
+    if (!bits(8, b))
+      return UNIT_NEED_INPUT;
+    storedLeft--;
+    return put(b) ? UNIT_DONE : UNIT_ERROR;
+  }
+
+  Unit huffmanSymbol() {
+    static const uint16_t lengthBase[29] PROGMEM = {
+        3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint8_t lengthExtra[29] PROGMEM = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t distBase[30] PROGMEM = {
+        1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+        33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const uint8_t distExtra[30] PROGMEM = {
+        0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    int sym = decode(literals);
+    if (sym == -1)
+      return UNIT_NEED_INPUT;
+    if (sym < 0 || sym > 285) {
+      fail("Bad literal code");
+      return UNIT_ERROR;
+    }
+    if (sym < 256)
+      return put(sym) ? UNIT_DONE : UNIT_ERROR;
+    if (sym == 256) {
+      endBlock();
+      return UNIT_DONE;
+    }
+
+    // Length / distance pair
+    sym -= 257;
+    uint32_t extra;
+    if (!bits(pgm_read_byte(&lengthExtra[sym]), extra))
+      return UNIT_NEED_INPUT;
+    int length = pgm_read_word(&lengthBase[sym]) + extra;
+
+    int dsym = decode(distances);
+    if (dsym == -1)
+      return UNIT_NEED_INPUT;
+    if (dsym < 0 || dsym > 29) {
+      fail("Bad distance code");
+      return UNIT_ERROR;
+    }
+    if (!bits(pgm_read_byte(&distExtra[dsym]), extra))
+      return UNIT_NEED_INPUT;
+    uint32_t distance = pgm_read_word(&distBase[dsym]) + extra;
+
+    if (distance > totalOut || distance > INFLATE_WINDOW_SIZE) {
+      windowExceeded = distance <= totalOut;
+      fail(windowExceeded ? "Distance beyond window" : "Distance before start");
+      return UNIT_ERROR;
+    }
+    while (length--) {
+      if (!put(window[(totalOut - distance) & (INFLATE_WINDOW_SIZE - 1)]))
+        return UNIT_ERROR;
+    }
+    return UNIT_DONE;
+  }
+
+  Unit wrapperTrailer() {
+    alignToByte();
+    int trailerBytes = wrapper == WRAP_GZIP   ? 8  // CRC32, ISIZE
+                       : wrapper == WRAP_ZLIB ? 4  // Adler-32
+                                              : 0;
+    uint32_t skip;
+    for (int i = 0; i < trailerBytes; i++) {
+      if (!bits(8, skip))
+        return UNIT_NEED_INPUT;
+    }
+    phase = PHASE_FINISHED;
+    return UNIT_DONE;
+  }
+
+  // Decode as many whole units as the buffered input allows
+  void run() {
+    while (phase != PHASE_FINISHED && phase != PHASE_FAILED) {
+      BitPosition start = mark();
+      Unit u;
+      switch (phase) {
+      case PHASE_WRAPPER_HEADER:
+        u = wrapperHeader();
+        if (u == UNIT_DONE)
+          phase = PHASE_BLOCK_HEADER;
+        break;
+      case PHASE_BLOCK_HEADER:
+        u = blockHeader();
+        break;
+      case PHASE_STORED:
+        u = storedByte();
+        break;
+      case PHASE_HUFFMAN:
+        u = huffmanSymbol();
+        break;
+      default:
+        u = wrapperTrailer();
+        break;
+      }
+      if (u == UNIT_NEED_INPUT) {
+        rewind(start);
+        return;
+      }
+      if (u == UNIT_ERROR)
+        return;
+    }
+  }
+
+public:
+  StreamInflater() { begin(FORMAT_GZIP); }
+
+  void onOutputData(OutputHandler handler) { onOutput = handler; }
+
+  void begin(Format f) {
+    format = f;
+    wrapper = WRAP_RAW;
+    phase = PHASE_WRAPPER_HEADER;
+    inLen = 0;
+    inPos = 0;
+    bitBuf = 0;
+    bitCount = 0;
+    totalOut = 0;
+    outLen = 0;
+    lastBlock = false;
+    storedLeft = 0;
+    error = nullptr;
+    windowExceeded = false;
+  }
+
+  // Returns false once the stream is broken
+  bool feed(const uint8_t *data, size_t len) {
+    while (len > 0 && phase != PHASE_FAILED && phase != PHASE_FINISHED) {
+      // Drop consumed bytes, then top up the buffer
+      if (inPos > 0) {
+        memmove(input, input + inPos, inLen - inPos);
+        inLen -= inPos;
+        inPos = 0;
+      }
+      size_t n = INFLATE_INPUT_MAX - inLen;
+      if (n == 0)
+        return fail("Unit larger than input buffer");
+      if (n > len)
+        n = len;
+      memcpy(input + inLen, data, n);
+      inLen += n;
+      data += n;
+      len -= n;
+      run();
+    }
+    // Hand over what this chunk produced right away
+    if (phase != PHASE_FAILED)
+      flushOutput();
+    return phase != PHASE_FAILED;
+  }
+
+  bool isFinished() const { return phase == PHASE_FINISHED; }
+  bool isFailed() const { return phase == PHASE_FAILED; }
+  const char *getError() const { return error ? error : ""; }
+  // The stream is valid but was compressed with a window over
+  // INFLATE_WINDOW_SIZE; only an uncompressed copy can be read
+  bool isWindowExceeded() const { return windowExceeded; }
+  uint32_t getTotalOut() const { return totalOut; }
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef WIFIFASTCONNECT_H
+#define WIFIFASTCONNECT_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+
+// A fast-path connect (known BSSID and channel, no scan) that hasn't
+// succeeded by now falls back to a full scan
+#ifndef WIFI_FAST_TIMEOUT
+#define WIFI_FAST_TIMEOUT 4000
+#endif
+
+// Also reuse the last IP lease as a static config, skipping DHCP.
+// Saves another ~0.5-1 s, but needs the router to keep handing this
+// device the same address (a DHCP reservation is the safe way): nothing
+// checks that the address is still free, so it is off unless asked for.
+#ifndef WIFI_REUSE_IP
+#define WIFI_REUSE_IP 0
+#endif
+
+#define WIFI_LEASE_FILE "/wifi.bin"
+#define WIFI_LEASE_RTC_OFFSET 0 // In 4-byte blocks of RTC user memory
+
+// Everything needed to rejoin the last network without scanning
+struct WiFiLease {
+  uint32_t checksum; // Over the fields below and the SSID/password
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+// Joins WiFi using the access point, channel and lease of the last good
+// connection, falling back to a normal scan + DHCP if that fails.
+//
+// The lease lives in RTC memory (survives resets and deep sleep, but not
+// power loss) and in a LittleFS file (survives everything, rewritten only
+// when the lease changes). Stored leases are checked against the current
+// credentials, so changing Config.h invalidates them.
+class WiFiFastConnect {
+private:
+  const char *ssid;
+  const char *password;
+
+  WiFiLease lease;
+  bool haveLease;
+  bool fastPath;    // Current attempt uses the lease
+  unsigned long attemptStart;
+
+  static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+  }
+
+  uint32_t checksumOf(const WiFiLease &l) const {
+    uint32_t hash = 2166136261UL;
+    hash = fnv1a(hash, (const uint8_t *)&l + sizeof(l.checksum),
+                 sizeof(l) - sizeof(l.checksum));
+    hash = fnv1a(hash, (const uint8_t *)ssid, strlen(ssid));
+    return fnv1a(hash, (const uint8_t *)password, strlen(password));
+  }
+
+  bool isValid(const WiFiLease &l) const {
+    return l.checksum == checksumOf(l) && l.channel >= 1 && l.channel <= 14;
+  }
+
+  bool loadLease() {
+    ESP.rtcUserMemoryRead(WIFI_LEASE_RTC_OFFSET, (uint32_t *)&lease,
+                          sizeof(lease));
+    if (isValid(lease)) {
+      return true;
+    }
+
+    // Cold boot: RTC memory is random, try the flash copy
+    File f = LittleFS.open(WIFI_LEASE_FILE, "r");
+    if (!f) {
+      return false;
+    }
+    bool ok = f.read((uint8_t *)&lease, sizeof(lease)) == sizeof(lease);
+    f.close();
+    return ok && isValid(lease);
+  }
+
+  void startFullScan() {
+    fastPath = false;
+    attemptStart = millis();
+    WiFi.disconnect();
+    // All-zero config turns DHCP back on
+    WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0),
+                IPAddress(0, 0, 0, 0));
+    WiFi.begin(ssid, password);
+  }
+
+public:
+  WiFiFastConnect(const char *_ssid, const char *_password)
+      : ssid(_ssid), password(_password), haveLease(false), fastPath(false),
+        attemptStart(0) {}
+
+  // Start connecting (non-blocking). LittleFS must be mounted for the
+  // flash copy to be used.
+  void begin() {
+    // The lease is our own cache; stop the SDK rewriting its config
+    // sector on every begin()
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+
+    if (!haveLease) {
+      haveLease = loadLease();
+    }
+    if (!haveLease) {
+      startFullScan();
+      return;
+    }
+
+    fastPath = true;
+    attemptStart = millis();
+#if WIFI_REUSE_IP
+    WiFi.config(IPAddress(lease.ip), IPAddress(lease.gateway),
+                IPAddress(lease.subnet), IPAddress(lease.dns));
+#endif
+    WiFi.begin(ssid, password, lease.channel, lease.bssid);
+  }
+
+  // Call while not connected: gives up on the fast path when it fails
+  void update(unsigned long now) {
+    if (!fastPath) {
+      return;
+    }
+    wl_status_t status = WiFi.status();
+    if (status == WL_NO_SSID_AVAIL || status == WL_CONNECT_FAILED ||
+        now - attemptStart > WIFI_FAST_TIMEOUT) {
+      Serial.println("WiFi fast connect failed, scanning...");
+      forget();
+      startFullScan();
+    }
+  }
+
+  // Call once connected: keeps the lease for the next connect
+  void remember() {
+    WiFiLease fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    memcpy(fresh.bssid, WiFi.BSSID(), sizeof(fresh.bssid));
+    fresh.channel = WiFi.channel();
+    fresh.ip = (uint32_t)WiFi.localIP();
+    fresh.gateway = (uint32_t)WiFi.gatewayIP();
+    fresh.subnet = (uint32_t)WiFi.subnetMask();
+    fresh.dns = (uint32_t)WiFi.dnsIP();
+    fresh.checksum = checksumOf(fresh);
+
+    ESP.rtcUserMemoryWrite(WIFI_LEASE_RTC_OFFSET, (uint32_t *)&fresh,
+                           sizeof(fresh));
+    if (haveLease && memcmp(&fresh, &lease, sizeof(fresh)) == 0) {
+      return; // Flash copy is already current
+    }
+
+    File f = LittleFS.open(WIFI_LEASE_FILE, "w");
+    if (f) {
+      f.write((const uint8_t *)&fresh, sizeof(fresh));
+      f.close();
+    }
+    lease = fresh;
+    haveLease = true;
+  }
+
+  // Drop the stored lease, so the next connect scans and uses DHCP
+  void forget() {
+    haveLease = false;
+    memset(&lease, 0, sizeof(lease));
+    ESP.rtcUserMemoryWrite(WIFI_LEASE_RTC_OFFSET, (uint32_t *)&lease,
+                           sizeof(lease));
+    LittleFS.remove(WIFI_LEASE_FILE);
+  }
+
+  bool usedFastPath() const { return fastPath; }
+};
+
+#endif
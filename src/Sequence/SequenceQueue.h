@@ -2,46 +2,99 @@
 #define SEQUENCE_QUEUE_H
 
 #include "SequenceTypes.h"
-#include <vector>
 
 // Define a max queue size to prevent memory issues
 #define MAX_QUEUE_SIZE 20
 
+// Fixed-capacity FIFO of steps. A ring buffer, so push and pop are O(1)
+// and never shift the remaining steps around.
 class SequenceQueue {
 private:
-  std::vector<SequenceStep> queue;
+  SequenceStep steps[MAX_QUEUE_SIZE];
+  int head;  // Index of the front step
+  int count; // Number of queued steps
+
+  // Playback time, kept up to date so remainingMs() is O(1)
+  uint32_t queuedMs;          // Sum of displayMs of all queued steps
+  unsigned long headStartTime; // When the front step started playing
+  bool headPlaying;
+
+  uint32_t version; // Bumped on every change, so savers can skip no-ops
 
 public:
-  SequenceQueue() {}
+  SequenceQueue()
+      : head(0), count(0), queuedMs(0), headStartTime(0),
+        headPlaying(false), version(0) {}
 
   bool add(const SequenceStep &step) {
-    if (queue.size() >= MAX_QUEUE_SIZE) {
+    if (count >= MAX_QUEUE_SIZE) {
       return false;
     }
-    queue.push_back(step);
+    steps[(head + count) % MAX_QUEUE_SIZE] = step;
+    count++;
+    queuedMs += step.displayMs;
+    version++;
     return true;
   }
 
-  bool isEmpty() const { return queue.empty(); }
+  int freeSlots() const { return MAX_QUEUE_SIZE - count; }
 
-  // Peek at the first item
-  bool peek(SequenceStep &step) const {
+  bool isEmpty() const { return count == 0; }
+
+  // Peek at the first item. Returns nullptr if the queue is empty.
+  // The pointer stays valid until the next pop() or clear().
+  const SequenceStep *peek() const {
     if (isEmpty())
-      return false;
-    step = queue.front();
-    return true;
+      return nullptr;
+    return &steps[head];
+  }
+
+  // The front step started playing (it stays queued until pop())
+  void markHeadStarted(unsigned long now) {
+    headStartTime = now;
+    headPlaying = true;
+  }
+
+  // How long the queued steps will keep the display busy from `now`
+  uint32_t remainingMs(unsigned long now) const {
+    if (isEmpty())
+      return 0;
+    uint32_t played = 0;
+    if (headPlaying) {
+      played = now - headStartTime;
+      if (played > steps[head].displayMs)
+        played = steps[head].displayMs;
+    }
+    return queuedMs - played;
   }
 
   // Remove the first item
   void pop() {
     if (!isEmpty()) {
-      queue.erase(queue.begin());
+      queuedMs -= steps[head].displayMs;
+      head = (head + 1) % MAX_QUEUE_SIZE;
+      count--;
+      headPlaying = false;
+      version++;
     }
   }
 
-  int size() const { return queue.size(); }
+  int size() const { return count; }
+
+  void clear() {
+    head = 0;
+    count = 0;
+    queuedMs = 0;
+    headPlaying = false;
+    version++;
+  }
+
+  // i-th step from the front (0 = playing / next to play)
+  const SequenceStep &at(int i) const {
+    return steps[(head + i) % MAX_QUEUE_SIZE];
+  }
 
-  void clear() { queue.clear(); }
+  uint32_t getVersion() const { return version; }
 };
 
 #endif
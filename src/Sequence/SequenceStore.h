@@ -0,0 +1,157 @@
+#ifndef SEQUENCE_STORE_H
+#define SEQUENCE_STORE_H
+
+#include "../Network/BinaryStepStream.h"
+#include "SequenceQueue.h"
+#include "StepBatch.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define STORE_QUEUE_FILE "/queue.bin"
+#define STORE_BATCH_FILE "/batch.bin"
+
+// Flash wear limits: the unplayed queue is written at most once a minute
+// (and only if it changed), the last good batch at most every 5 minutes
+#define STORE_QUEUE_INTERVAL 60000
+#define STORE_BATCH_INTERVAL 300000
+
+// Keeps the unplayed steps and the last good batch on LittleFS, so the
+// next power-up can start playing before WiFi and the API are back.
+//
+// Files use the packed step format of BinaryStepStream.h and are loaded
+// with the same decoder. Each write goes to a temp file that is renamed
+// over the old one, so a power cut never leaves a half-written cache.
+class SequenceStore {
+private:
+  SequenceQueue &queue;
+  bool mounted;
+  uint32_t savedVersion;
+  unsigned long lastQueueWrite;
+  unsigned long lastBatchWrite;
+  bool batchWritten; // At least once since boot
+
+  static size_t encodeStep(const SequenceStep &step, uint8_t *out) {
+    size_t textLength = strlen(step.text);
+    out[0] = step.expression;
+    out[1] = step.beepMs & 0xFF;
+    out[2] = step.beepMs >> 8;
+    out[3] = step.soundPattern;
+    for (int i = 0; i < 4; i++)
+      out[4 + i] = (step.displayMs >> (8 * i)) & 0xFF;
+    out[8] = textLength;
+    memcpy(out + 9, step.text, textLength);
+    return 9 + textLength;
+  }
+
+  template <typename Steps>
+  bool writeSteps(const char *path, const Steps &steps, int count) {
+    File f = LittleFS.open("/store.tmp", "w");
+    if (!f) {
+      return false;
+    }
+    const uint8_t header[3] = {'J', 'S', STEP_WIRE_VERSION};
+    bool ok = f.write(header, 3) == 3;
+    uint8_t record[9 + STEP_TEXT_MAX];
+    for (int i = 0; ok && i < count; i++) {
+      size_t n = encodeStep(steps.at(i), record);
+      ok = f.write(record, n) == n;
+    }
+    f.close();
+    return ok && LittleFS.rename("/store.tmp", path);
+  }
+
+  int readSteps(const char *path) {
+    File f = LittleFS.open(path, "r");
+    if (!f) {
+      return 0;
+    }
+
+    int loaded = 0;
+    BinaryStepStream decoder;
+    decoder.onStepComplete([&](const StepRecord &record) {
+      SequenceStep step;
+      step.expression = Eye::expressionFromId(record.expression);
+      step.beepMs = record.beepMs;
+      step.soundPattern = record.soundPattern < SOUND_PATTERN_COUNT
+                              ? record.soundPattern
+                              : SOUND_NONE;
+      step.displayMs = record.displayMs;
+      step.setText(record.text);
+      if (queue.add(step)) {
+        loaded++;
+      }
+    });
+
+    uint8_t buf[64];
+    int n;
+    while ((n = f.read(buf, sizeof(buf))) > 0 && !decoder.isMalformed()) {
+      decoder.feed(buf, n);
+    }
+    f.close();
+    return loaded;
+  }
+
+public:
+  SequenceStore(SequenceQueue &_queue)
+      : queue(_queue), mounted(false), savedVersion(0), lastQueueWrite(0),
+        lastBatchWrite(0), batchWritten(false) {}
+
+  // Reports the mount (and load() the steps found) on Serial, so start
+  // Serial before calling either
+  void begin() {
+    mounted = LittleFS.begin();
+    if (!mounted) {
+      Serial.println("LittleFS mount failed, no offline cache");
+    }
+  }
+
+  // Fill the queue from flash: what was left unplayed, or else a replay
+  // of the last good batch. Returns the number of steps queued.
+  int load() {
+    if (!mounted) {
+      return 0;
+    }
+    int loaded = readSteps(STORE_QUEUE_FILE);
+    if (loaded == 0) {
+      loaded = readSteps(STORE_BATCH_FILE);
+    }
+    savedVersion = queue.getVersion(); // Already matches the flash copy
+    Serial.printf("Loaded %d cached steps.\n", loaded);
+    return loaded;
+  }
+
+  // A batch was received and fully parsed
+  void saveBatch(const StepBatch &batch) {
+    unsigned long now = millis();
+    if (!mounted || batch.isEmpty() ||
+        (batchWritten && now - lastBatchWrite < STORE_BATCH_INTERVAL)) {
+      return;
+    }
+    if (writeSteps(STORE_BATCH_FILE, batch, batch.size())) {
+      lastBatchWrite = now;
+      batchWritten = true;
+    }
+  }
+
+  // Write the unplayed queue if it changed and the interval has passed
+  void update(unsigned long now) {
+    if (!mounted || queue.getVersion() == savedVersion ||
+        now - lastQueueWrite < STORE_QUEUE_INTERVAL) {
+      return;
+    }
+    flush();
+    lastQueueWrite = now;
+  }
+
+  // Write the unplayed queue now (e.g. before a planned power-down)
+  void flush() {
+    if (!mounted) {
+      return;
+    }
+    if (writeSteps(STORE_QUEUE_FILE, queue, queue.size())) {
+      savedVersion = queue.getVersion();
+    }
+  }
+};
+
+#endif
@@ -1,13 +1,25 @@
 #ifndef SEQUENCE_TYPES_H
 #define SEQUENCE_TYPES_H
 
+#include "../Face/Eye.h"
+#include "../SoundPatterns.h"
 #include <Arduino.h>
 
+// Longest step text kept; longer text from the API is cut
+#define STEP_TEXT_MAX 80
+
+// Plain data, resolved once at ingest: no heap, fixed size in the queue
 struct SequenceStep {
-  String expression;     // e.g., "happy", "sad"
-  float beepDuration;    // seconds
-  String text;           // Display Text
-  float displayDuration; // seconds
+  Eye::Expression expression;
+  uint16_t beepMs;             // 0 = silent
+  uint8_t soundPattern;        // SoundPatternId; SOUND_NONE = use beepMs
+  uint32_t displayMs;
+  char text[STEP_TEXT_MAX + 1]; // Display Text, null-terminated
+
+  void setText(const char *s) {
+    strncpy(text, s ? s : "", STEP_TEXT_MAX);
+    text[STEP_TEXT_MAX] = '\0';
+  }
 };
 
 #endif
@@ -0,0 +1,73 @@
+#ifndef STEP_BATCH_H
+#define STEP_BATCH_H
+
+#include "SequenceQueue.h"
+
+// Steps held back from the queue
+#define STEP_BATCH_SIZE 10
+
+// Staging area for a response that is still being parsed. Steps only
+// reach the playing queue once the whole response has arrived and was
+// release()d, so a failed or cut-off fetch never leaves half a batch
+// interleaved with what is already playing. Released steps that don't fit
+// yet wait here for room, ahead of the next response's.
+class StepBatch {
+private:
+  SequenceStep steps[STEP_BATCH_SIZE];
+  int count;
+  int released; // steps[0, released) are complete and may be queued
+  int dropped;  // Didn't fit in the batch (response being staged)
+
+public:
+  StepBatch() : count(0), released(0), dropped(0) {}
+
+  bool add(const SequenceStep &step) {
+    if (count >= STEP_BATCH_SIZE) {
+      dropped++;
+      return false;
+    }
+    steps[count++] = step;
+    return true;
+  }
+
+  // The response is complete: its steps may go to the queue
+  void release() {
+    released = count;
+    dropped = 0;
+  }
+
+  // Drop the steps of a response that failed; released ones stay
+  void discard() {
+    count = released;
+    dropped = 0;
+  }
+
+  // Move as many released steps as the queue has room for, oldest first.
+  // Returns how many moved.
+  int commitTo(SequenceQueue &queue) {
+    int moved = 0;
+    while (moved < released && queue.add(steps[moved])) {
+      moved++;
+    }
+    for (int i = moved; i < count; i++) {
+      steps[i - moved] = steps[i];
+    }
+    count -= moved;
+    released -= moved;
+    return moved;
+  }
+
+  void clear() {
+    count = 0;
+    released = 0;
+    dropped = 0;
+  }
+
+  const SequenceStep &at(int i) const { return steps[i]; }
+  int size() const { return count; }
+  bool isEmpty() const { return count == 0; }
+  int getStaged() const { return count - released; } // Not yet released
+  int getDropped() const { return dropped; }
+};
+
+#endif
@@ -1,45 +1,174 @@
 #ifndef SOUNDMANAGER_H
 #define SOUNDMANAGER_H
 
+#include "SoundPatterns.h"
 #include <Arduino.h>
 
+// Segments waiting to play (power of two; longest pattern plus some)
+#define SOUND_QUEUE_SIZE 16
+
+// timer1 at TIM_DIV16 counts 5 ticks per microsecond, 23-bit counter
+#define SOUND_TICKS_PER_MS 5000UL
+#define SOUND_MAX_TICKS 8388607UL
+
+// Buzzer driven from the hardware timer (timer1), so a beep lasts exactly
+// as long as asked however late loop() runs. Sounds are queued as
+// segments (silent / on / square wave at a frequency) and the timer
+// interrupt steps through them; loop() only ever adds or clears segments.
+//
+// timer1 is also what the core's tone() and analogWrite() use, so neither
+// can be used alongside this. Only one SoundManager can exist.
 class SoundManager {
-  private:
-    int pin;
-    unsigned long beepStartTime;
-    int beepDuration;
-    bool isBeeping;
-    bool initialized;
-
-    void init() {
-      if (!initialized) {
-        pinMode(pin, OUTPUT);
-        digitalWrite(pin, LOW); // Ensure it starts silent (Active Low/High check)
-        initialized = true;
-      }
+private:
+  int pin;
+  bool initialized;
+
+  // Loop writes head, the ISR reads and advances tail
+  SoundSegment segments[SOUND_QUEUE_SIZE];
+  volatile uint8_t segHead;
+  volatile uint8_t segTail;
+  volatile bool running;
+
+  // ISR state for the current segment
+  uint32_t halfPeriod;  // Ticks per square wave half, 0 = no wave
+  uint32_t togglesLeft; // Square wave halves still to play
+  uint32_t waitTicks;   // Ticks still to wait beyond the armed slice
+  bool level;
+
+  static SoundManager *instance;
+
+  static void IRAM_ATTR onTimer() { instance->tick(); }
+
+  void IRAM_ATTR setLevel(bool high) {
+    level = high;
+    digitalWrite(pin, high ? HIGH : LOW);
+  }
+
+  // Arm the timer for `ticks`, in slices the 23-bit counter can hold
+  void IRAM_ATTR arm(uint32_t ticks) {
+    uint32_t slice = ticks > SOUND_MAX_TICKS ? SOUND_MAX_TICKS : ticks;
+    waitTicks = ticks - slice;
+    timer1_write(slice < 10 ? 10 : slice);
+  }
+
+  void IRAM_ATTR startNext() {
+    if (segTail == segHead) {
+      setLevel(false);
+      timer1_disable();
+      running = false;
+      return;
+    }
+    SoundSegment seg = segments[segTail];
+    segTail = (segTail + 1) & (SOUND_QUEUE_SIZE - 1);
+
+    uint32_t ticks = (uint32_t)seg.ms * SOUND_TICKS_PER_MS;
+    if (seg.freqHz <= SOUND_STEADY) {
+      halfPeriod = 0;
+      setLevel(seg.freqHz == SOUND_STEADY);
+      arm(ticks);
+    } else {
+      halfPeriod = SOUND_TICKS_PER_MS * 1000UL / (2UL * seg.freqHz);
+      togglesLeft = ticks / halfPeriod;
+      setLevel(true);
+      arm(halfPeriod);
+      togglesLeft = togglesLeft > 0 ? togglesLeft - 1 : 0;
     }
+  }
 
-  public:
-    SoundManager(int _pin) : pin(_pin), isBeeping(false), initialized(false) {}
+  void IRAM_ATTR tick() {
+    if (waitTicks > 0) {
+      arm(waitTicks);
+    } else if (halfPeriod && togglesLeft > 0) {
+      togglesLeft--;
+      setLevel(!level);
+      arm(halfPeriod);
+    } else {
+      startNext();
+    }
+  }
+
+  void init() {
+    if (!initialized) {
+      pinMode(pin, OUTPUT);
+      digitalWrite(pin, LOW); // Ensure it starts silent
+      instance = this;
+      timer1_attachInterrupt(onTimer);
+      initialized = true;
+    }
+  }
 
-    // REMOVED 'frequency' because active buzzers only have one tone!
-    void beep(int duration) {
-      init();
-      
-      if (isBeeping) return; 
-      
-      digitalWrite(pin, HIGH); // Turn sound ON
-      beepStartTime = millis();
-      beepDuration = duration;
-      isBeeping = true;
+  bool push(const SoundSegment &seg) {
+    uint8_t next = (segHead + 1) & (SOUND_QUEUE_SIZE - 1);
+    if (next == segTail) {
+      return false; // Full: the rest of the pattern is dropped
     }
+    segments[segHead] = seg;
+    segHead = next;
+    return true;
+  }
+
+  // Start the timer if it went idle. Segments are pushed before this
+  // check, so an ISR that is just finishing either sees them or has
+  // already cleared `running`.
+  void kick() {
+    if (!running && segTail != segHead) {
+      running = true;
+      timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+      startNext();
+    }
+  }
+
+public:
+  SoundManager(int _pin)
+      : pin(_pin), initialized(false), segHead(0), segTail(0),
+        running(false), halfPeriod(0), togglesLeft(0), waitTicks(0),
+        level(false) {}
 
-    void update() {
-      if (isBeeping && (millis() - beepStartTime >= (unsigned long)beepDuration)) {
-        digitalWrite(pin, LOW); // Turn sound OFF
-        isBeeping = false;
+  // Single beep of the active buzzer's own tone, replacing any sound
+  void beep(int duration) {
+    SoundSegment seg = {SOUND_STEADY, (uint16_t)duration};
+    stop();
+    push(seg);
+    kick();
+  }
+
+  // Built-in pattern (SoundPatterns.h), replacing any sound
+  void play(uint8_t patternId) {
+    stop();
+    queue(patternId);
+  }
+
+  // Built-in pattern, after whatever is already playing
+  void queue(uint8_t patternId) {
+    if (patternId == SOUND_NONE || patternId >= SOUND_PATTERN_COUNT) {
+      return;
+    }
+    init();
+    const SoundPattern &p = SOUND_PATTERNS[patternId];
+    for (uint8_t i = 0; i < p.count; i++) {
+      SoundSegment seg;
+      memcpy_P(&seg, &p.segments[i], sizeof(seg));
+      if (!push(seg)) {
+        break;
       }
     }
+    kick();
+  }
+
+  // Silence now and drop anything queued
+  void stop() {
+    init();
+    timer1_disable();
+    running = false;
+    segTail = segHead;
+    waitTicks = 0;
+    halfPeriod = 0;
+    setLevel(false);
+  }
+
+  bool isPlaying() const { return running; }
 };
 
-#endif
\ No newline at end of file
+SoundManager *SoundManager::instance = nullptr;
+
+#endif
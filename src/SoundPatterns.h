@@ -0,0 +1,72 @@
+#ifndef SOUNDPATTERNS_H
+#define SOUNDPATTERNS_H
+
+#include <Arduino.h>
+#include <strings.h>
+
+// One piece of a sound: the buzzer is silent, on, or driven with a square
+// wave for `ms` milliseconds
+struct SoundSegment {
+  uint16_t freqHz; // SOUND_SILENT, SOUND_STEADY or a frequency in Hz
+  uint16_t ms;
+};
+
+#define SOUND_SILENT 0
+#define SOUND_STEADY 1 // Pin held high: the active buzzer's own tone
+
+// Built-in patterns, referenced by id from SequenceStep::soundPattern and
+// by name ("Sound" in the API). Ids are part of the binary step format,
+// so only ever append.
+enum SoundPatternId : uint8_t {
+  SOUND_NONE,   // Plain beep of the step's beepMs, if any
+  SOUND_CHIRP,  // Short blip
+  SOUND_DOUBLE, // Two short beeps
+  SOUND_ALERT,  // Three long beeps
+  SOUND_RISE,   // Rising three-note melody
+  SOUND_FALL,   // Falling three-note melody
+  SOUND_PATTERN_COUNT
+};
+
+static const SoundSegment SOUND_CHIRP_SEGMENTS[] PROGMEM = {
+    {SOUND_STEADY, 40}};
+static const SoundSegment SOUND_DOUBLE_SEGMENTS[] PROGMEM = {
+    {SOUND_STEADY, 80}, {SOUND_SILENT, 80}, {SOUND_STEADY, 80}};
+static const SoundSegment SOUND_ALERT_SEGMENTS[] PROGMEM = {
+    {SOUND_STEADY, 250}, {SOUND_SILENT, 150}, {SOUND_STEADY, 250},
+    {SOUND_SILENT, 150}, {SOUND_STEADY, 250}};
+static const SoundSegment SOUND_RISE_SEGMENTS[] PROGMEM = {
+    {523, 90}, {SOUND_SILENT, 20}, {659, 90}, {SOUND_SILENT, 20}, {784, 160}};
+static const SoundSegment SOUND_FALL_SEGMENTS[] PROGMEM = {
+    {392, 160}, {SOUND_SILENT, 40}, {330, 160}, {SOUND_SILENT, 40},
+    {262, 300}};
+
+struct SoundPattern {
+  const char *name;
+  const SoundSegment *segments; // PROGMEM
+  uint8_t count;
+};
+
+#define SOUND_PATTERN(name, segs)                                             \
+  { name, segs, sizeof(segs) / sizeof(segs[0]) }
+
+static const SoundPattern SOUND_PATTERNS[SOUND_PATTERN_COUNT] = {
+    {"none", nullptr, 0},
+    SOUND_PATTERN("chirp", SOUND_CHIRP_SEGMENTS),
+    SOUND_PATTERN("double", SOUND_DOUBLE_SEGMENTS),
+    SOUND_PATTERN("alert", SOUND_ALERT_SEGMENTS),
+    SOUND_PATTERN("rise", SOUND_RISE_SEGMENTS),
+    SOUND_PATTERN("fall", SOUND_FALL_SEGMENTS)};
+
+// Case-insensitive; unknown or missing names give SOUND_NONE
+inline uint8_t soundPatternFromName(const char *name) {
+  if (name) {
+    for (uint8_t i = 1; i < SOUND_PATTERN_COUNT; i++) {
+      if (strcasecmp(name, SOUND_PATTERNS[i].name) == 0) {
+        return i;
+      }
+    }
+  }
+  return SOUND_NONE;
+}
+
+#endif
@@ -1,7 +1,14 @@
 #ifndef TEXTBOX_H
 #define TEXTBOX_H
 
+#include "Debug/LoopProfiler.h"
 #include <U8g2lib.h>
+#include <string.h>
+
+// Layout table limits. Text past TEXTBOX_MAX_CHARS is cut off, and lines
+// past TEXTBOX_MAX_LINES would be below any box on a 64 px screen anyway.
+#define TEXTBOX_MAX_CHARS 128
+#define TEXTBOX_MAX_LINES 6
 
 enum TextAlign { ALIGN_LEFT, ALIGN_CENTER, ALIGN_RIGHT };
 
@@ -11,7 +18,20 @@ private:
   int targetHeight;
   int width;
   TextAlign align;
-  String text;
+  char text[TEXTBOX_MAX_CHARS + 1]; // Fixed: setText() never allocates
+
+  // Cached word-wrap layout, rebuilt on the first draw after a change.
+  // layoutText holds the text with each line's end replaced by '\0', so
+  // every line can go straight to drawStr().
+  struct LineLayout {
+    int16_t start; // Offset into layoutText, -1 for an empty line
+    int16_t length;
+    int16_t drawX;
+  };
+  char layoutText[TEXTBOX_MAX_CHARS + 1];
+  LineLayout lines[TEXTBOX_MAX_LINES];
+  int lineCount;
+  bool layoutValid;
 
   // Internal pointer to the specific font data
   const uint8_t *fontData;
@@ -34,79 +54,139 @@ public:
   // Width defaults to 0 (Auto), Align defaults to LEFT
   TextBox(int _x, int _y, int _height, int _width = 0,
           TextAlign _align = ALIGN_LEFT)
-      : x(_x), y(_y), targetHeight(_height), width(_width), align(_align) {
+      : x(_x), y(_y), targetHeight(_height), width(_width), align(_align),
+        lineCount(0), layoutValid(false) {
 
-    text = "";
+    text[0] = '\0';
     selectFont(); // Pick the best font immediately
   }
 
-  void setText(String t) { text = t; }
+  // Returns true if the text actually changed (i.e. a redraw is needed)
+  bool setText(const char *t) {
+    if (!t)
+      t = "";
+    if (strncmp(t, text, TEXTBOX_MAX_CHARS) == 0)
+      return false;
+    strncpy(text, t, TEXTBOX_MAX_CHARS);
+    text[TEXTBOX_MAX_CHARS] = '\0';
+    layoutValid = false;
+    return true;
+  }
 
   // You can also change properties on the fly if needed
-  void setAlignment(TextAlign a) { align = a; }
+  void setAlignment(TextAlign a) {
+    align = a;
+    layoutValid = false;
+  }
 
   void draw(U8G2 &u8g2) {
-    if (text.length() == 0)
+    PROFILE_SCOPE(PROF_TEXT_DRAW);
+    if (text[0] == '\0')
       return;
 
     u8g2.setFont(fontData);
     u8g2.setDrawColor(1);
     u8g2.setFontMode(1); // Transparent
 
+    if (!layoutValid) {
+      buildLayout(u8g2);
+    }
+
     int lineHeight = targetHeight; // Approximate line height
     int currentY = y + lineHeight; // Baseline of first line
 
+    for (int i = 0; i < lineCount; i++) {
+      if (lines[i].start >= 0) {
+        u8g2.drawStr(lines[i].drawX, currentY, layoutText + lines[i].start);
+      }
+      currentY += lineHeight;
+    }
+  }
+
+private:
+  int alignedX(int strWidth) const {
+    int drawX = x;
+    if (width <= 0) // Auto width: single line, no alignment
+      return drawX;
+    if (align == ALIGN_CENTER)
+      drawX += (width - strWidth) / 2;
+    else if (align == ALIGN_RIGHT)
+      drawX += (width - strWidth);
+    return drawX;
+  }
+
+  // Width of layoutText[start, end) without copying it
+  int measure(U8G2 &u8g2, int start, int end) {
+    char saved = layoutText[end];
+    layoutText[end] = '\0';
+    int w = u8g2.getStrWidth(layoutText + start);
+    layoutText[end] = saved;
+    return w;
+  }
+
+  void addLine(U8G2 &u8g2, int start, int len) {
+    if (lineCount >= TEXTBOX_MAX_LINES)
+      return;
+    LineLayout &line = lines[lineCount++];
+    if (len == 0) {
+      line.start = -1;
+      line.length = 0;
+      line.drawX = x;
+      return;
+    }
+    line.start = start;
+    line.length = len;
+    line.drawX = alignedX(measure(u8g2, start, start + len));
+  }
+
+  // Word Wrapping Logic
+  // Greedy wrap on single spaces. Lines are always contiguous runs of the
+  // original text, so they are stored as offsets instead of new strings.
+  void buildLayout(U8G2 &u8g2) {
+    int n = strlen(text);
+    memcpy(layoutText, text, n);
+    layoutText[n] = '\0';
+    lineCount = 0;
+    layoutValid = true;
+
     // If no width constraint, draw single line
     if (width <= 0) {
-      u8g2.drawStr(x, currentY, text.c_str());
+      addLine(u8g2, 0, n);
       return;
     }
 
-    // Word Wrapping Logic
-    String currentLine = "";
-    String remaining = text;
+    int lineStart = 0;
+    int lineLen = 0; // 0 = current line is empty
+    int pos = 0;
 
-    while (remaining.length() > 0) {
-      int spaceIndex = remaining.indexOf(' ');
-      String word;
-      if (spaceIndex == -1) {
-        word = remaining;
-        remaining = "";
-      } else {
-        word = remaining.substring(0, spaceIndex);
-        remaining = remaining.substring(spaceIndex + 1);
-      }
+    while (pos < n) {
+      int wordEnd = pos;
+      while (wordEnd < n && layoutText[wordEnd] != ' ')
+        wordEnd++;
 
-      String testLine =
-          currentLine.length() > 0 ? currentLine + " " + word : word;
-      if (u8g2.getStrWidth(testLine.c_str()) <= width) {
-        currentLine = testLine;
+      // Current line plus " word", or just the word on an empty line
+      int testStart = lineLen > 0 ? lineStart : pos;
+      if (measure(u8g2, testStart, wordEnd) <= width) {
+        lineStart = testStart;
+        lineLen = wordEnd - testStart;
       } else {
-        // Draw the full line we had before adding this overflow word
-        int drawX = x;
-        int strWidth = u8g2.getStrWidth(currentLine.c_str());
-
-        if (align == ALIGN_CENTER)
-          drawX += (width - strWidth) / 2;
-        else if (align == ALIGN_RIGHT)
-          drawX += (width - strWidth);
-
-        u8g2.drawStr(drawX, currentY, currentLine.c_str());
-
-        // Move down
-        currentY += lineHeight;
-        currentLine = word; // Start new line with the word that didn't fit
+        // Emit the line we had before adding this overflow word
+        addLine(u8g2, lineStart, lineLen);
+        lineStart = pos; // Start new line with the word that didn't fit
+        lineLen = wordEnd - pos;
       }
+      pos = wordEnd + 1; // Skip the separating space
+    }
+    // The final remainder line
+    if (lineLen > 0) {
+      addLine(u8g2, lineStart, lineLen);
     }
-    // Draw the final remainder line
-    if (currentLine.length() > 0) {
-      int drawX = x;
-      int strWidth = u8g2.getStrWidth(currentLine.c_str());
-      if (align == ALIGN_CENTER)
-        drawX += (width - strWidth) / 2;
-      else if (align == ALIGN_RIGHT)
-        drawX += (width - strWidth);
-      u8g2.drawStr(drawX, currentY, currentLine.c_str());
+
+    // Terminate every line in place (the byte after a line is always the
+    // space that separated it from the next word, or the end of the text)
+    for (int i = 0; i < lineCount; i++) {
+      if (lines[i].start >= 0)
+        layoutText[lines[i].start + lines[i].length] = '\0';
     }
   }
 };
@@ -3,12 +3,19 @@
 #include <Wire.h>
 
 #include "Config.h"
+#include "Debug/HeapStats.h"
+#include "Display/DisplayBackend.h"
+#include "Input/ButtonInput.h"
+#include "Manager/BootTimeline.h"
+#include "Manager/FrameScheduler.h"
 #include "Manager/JumboController.h"
+#include "Manager/Standby.h"
 #include "Network/APIClient.h"
 #include "Sequence/SequenceQueue.h"
+#include "Sequence/SequenceStore.h"
 
-// U8g2 Constructor
-U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE, D1, D2);
+// U8g2 Constructor (full or page buffer, see DISPLAY_BUFFER_PAGES)
+DisplayDriver u8g2(U8G2_R0, U8X8_PIN_NONE, D1, D2);
 
 // 1. Shared Sequence Queue
 SequenceQueue sequenceQueue;
@@ -19,68 +26,103 @@ JumboController controller(u8g2, sequenceQueue, D5); // Buzzer on D5
 // 3. API Client (Fetches data into Queue)
 APIClient apiClient(sequenceQueue);
 
-// 4. Standby State
-bool isStandby = false;
-unsigned long lastButtonPress = 0;
+// 4. Flash cache (plays the last steps while the network comes up)
+SequenceStore sequenceStore(sequenceQueue);
+
+// 5. Render pacing (TARGET_FPS, redraw only when something changed)
+FrameScheduler frameScheduler;
+
+// 6. Boot phase timing (logged to serial)
+BootTimeline bootTimeline;
+
+// 7. Flash button (interrupt-driven: tap, double-tap, long-press)
+ButtonInput button(FLASH_BUTTON_PIN);
+
+// 8. Standby (radio off, light sleep, wake on the button)
+Standby standby(FLASH_BUTTON_PIN);
 
 void setup() {
+  // Serial first: boot timing and cache diagnostics are logged from here on
+  Serial.begin(115200);
+
   // Initialize Display
   u8g2.begin();
+  bootTimeline.mark(BootTimeline::DISPLAY_READY);
 
   // Initialize Flash Button
-  pinMode(FLASH_BUTTON_PIN, INPUT_PULLUP);
+  button.begin();
 
   // Initialize Components
   controller.begin();
 
-  // Wire up granular debug logging
-  apiClient.setStatusCallback([](const String &msg) {
-    controller.setText(msg);
-    controller.draw();
-    delay(10); // Yield to let display refresh
-  });
+  // Queue cached steps first, so playback starts before WiFi is up (both
+  // log to Serial, started above)
+  sequenceStore.begin();
+  sequenceStore.load();
+
+  // Wire up granular debug logging (drawn by the regular frame loop)
+  apiClient.setStatusCallback(
+      [](const char *msg) { controller.setText(msg); });
+  apiClient.setBatchCallback(
+      [](const StepBatch &batch) { sequenceStore.saveBatch(batch); });
+  apiClient.setBootTimeline(&bootTimeline);
 
   apiClient.begin();
 }
 
 void loop() {
-  // 1. Handle Sleep/Resume Button
-  if (digitalRead(FLASH_BUTTON_PIN) == LOW) {
-    if (millis() - lastButtonPress > 500) {
-      isStandby = !isStandby;
-      lastButtonPress = millis();
-
-      if (isStandby) {
-        // Entering Sleep
-        controller.forceSleep();
-      } else {
-        // Waking Up
-        // No special action needed, loop will resume updates
-        // Maybe restore "IP..." or "Wake" text?
-        // Let's just let it resume whatever was happening or go to idle
-        controller.setText("Resuming...");
-      }
+  // 1. Standby: sleep until the button wakes us, nothing else runs
+  if (standby.isActive()) {
+    if (standby.sleep()) {
+      standby.exit();
+      button.begin();         // Light sleep took over the pin interrupt
+      button.reset(millis()); // The wake press is not a new gesture
+      controller.setText("Resuming...");
     }
+    return;
   }
 
-  if (isStandby) {
-    // In Standby, we don't update network or controller logic
-    // We just keep drawing the static sleep frame (handled by controller state)
-    // Actually controller.draw() is called at end, so we just skip updates
-    delay(100); // Slow down loop to save power/cpu
-  } else {
-    // 2. Regular Updates
-    apiClient.update();
-    controller.update();
+  // Time the awake part of the loop; print the profile every few seconds
+  // (both only in JUMBO_PROFILE builds)
+  PROFILE_REPORT(millis());
+  PROFILE_SCOPE(PROF_LOOP);
+
+  // Heap and allocations-per-loop telemetry (nodemcuv2_heapstats only)
+  HEAP_STATS_UPDATE(millis());
+
+  // 2. Handle the Button (tap: standby, double-tap: skip the step)
+  button.update(millis());
+  switch (button.nextGesture()) {
+  case ButtonInput::TAP:
+    // Draw the sleep frame once, save what is left, then power down
+    controller.forceSleep();
+    sequenceStore.flush();
+    standby.enter();
+    return;
+  case ButtonInput::DOUBLE_TAP:
+    controller.skipStep();
+    break;
+  default:
+    break;
   }
 
-  // 3. Override Text during Boot (Only if not sleeping to avoid fighting)
+  // 3. Regular Updates
+  apiClient.update();
+  controller.update();
+  sequenceStore.update(millis());
+  standby.update();
 
-  // 3. Override Text during Boot
+  // 4. Override Text during Boot
   if (!apiClient.isBootComplete()) {
     controller.setText(apiClient.getBootStatus());
   }
 
-  // 4. Draw Frame
-  controller.draw();
-}
\ No newline at end of file
+  // 5. Draw Frame (at the target rate, and only if the picture changed)
+  if (frameScheduler.frameDue(millis()) && controller.needsRedraw()) {
+    controller.draw();
+    standby.frameShown();
+    if (controller.isPlaying()) {
+      bootTimeline.mark(BootTimeline::FIRST_STEP);
+    }
+  }
+}
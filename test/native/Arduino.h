@@ -0,0 +1,394 @@
+#ifndef ARDUINO_STUB_H
+#define ARDUINO_STUB_H
+
+// Host-side stand-in for the Arduino core, used by [env:native].
+// Only the parts of the API the firmware headers touch are provided.
+// Time is fully simulated: millis()/micros() return a mock clock that the
+// tests advance explicitly, so every run is reproducible.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+
+#define CHANGE 3
+
+// NodeMCU pin aliases
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define memcpy_P memcpy
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+// --- Mock Hardware State ---
+namespace ArduinoMock {
+inline unsigned long nowMicros = 0;
+inline uint32_t randomState = 1;
+inline int pinModes[17] = {0};
+inline int pinLevels[17] = {0};
+inline unsigned long digitalWrites = 0;
+inline void (*pinInterrupts[17])() = {nullptr};
+inline void (*timer1Callback)() = nullptr;
+inline bool timer1Enabled = false;
+inline uint32_t timer1Ticks = 0;
+
+inline void setMillis(unsigned long ms) { nowMicros = ms * 1000UL; }
+inline void advanceMillis(unsigned long ms) { nowMicros += ms * 1000UL; }
+inline void advanceMicros(unsigned long us) { nowMicros += us; }
+
+inline void reset() {
+  nowMicros = 0;
+  randomState = 1;
+  digitalWrites = 0;
+  for (int i = 0; i < 17; i++) {
+    pinModes[i] = 0;
+    pinLevels[i] = HIGH; // Pull-ups idle high
+    pinInterrupts[i] = nullptr;
+  }
+}
+
+// Drive an input pin, firing its CHANGE interrupt if one is attached
+inline void setPin(uint8_t pin, int level) {
+  if (pin >= 17 || pinLevels[pin] == level)
+    return;
+  pinLevels[pin] = level;
+  if (pinInterrupts[pin])
+    pinInterrupts[pin]();
+}
+} // namespace ArduinoMock
+
+inline unsigned long millis() { return ArduinoMock::nowMicros / 1000UL; }
+inline unsigned long micros() { return ArduinoMock::nowMicros; }
+inline void delay(unsigned long ms) { ArduinoMock::advanceMillis(ms); }
+inline void delayMicroseconds(unsigned int us) {
+  ArduinoMock::advanceMicros(us);
+}
+inline void yield() {}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < 17)
+    ArduinoMock::pinModes[pin] = mode;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < 17)
+    ArduinoMock::pinLevels[pin] = val;
+  ArduinoMock::digitalWrites++;
+}
+
+inline int digitalRead(uint8_t pin) {
+  return pin < 17 ? ArduinoMock::pinLevels[pin] : LOW;
+}
+
+// --- Pin interrupts (every attached mode behaves as CHANGE) ---
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t pin, void (*isr)(), int) {
+  if (pin < 17)
+    ArduinoMock::pinInterrupts[pin] = isr;
+}
+
+// --- timer1 (armed but never fires on its own; tests call the callback) ---
+#define TIM_DIV16 1
+#define TIM_EDGE 0
+#define TIM_SINGLE 0
+
+inline void timer1_attachInterrupt(void (*cb)()) {
+  ArduinoMock::timer1Callback = cb;
+}
+inline void timer1_enable(uint8_t, uint8_t, uint8_t) {
+  ArduinoMock::timer1Enabled = true;
+}
+inline void timer1_disable() { ArduinoMock::timer1Enabled = false; }
+inline void timer1_write(uint32_t ticks) { ArduinoMock::timer1Ticks = ticks; }
+
+// Deterministic LCG so "random" animation is reproducible across runs
+inline void randomSeed(unsigned long seed) {
+  ArduinoMock::randomState = seed ? seed : 1;
+}
+
+inline long random(long howbig) {
+  if (howbig <= 0)
+    return 0;
+  ArduinoMock::randomState = ArduinoMock::randomState * 1103515245u + 12345u;
+  return (long)((ArduinoMock::randomState >> 1) % (uint32_t)howbig);
+}
+
+inline long random(long howsmall, long howbig) {
+  if (howsmall >= howbig)
+    return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+template <typename T, typename L, typename H>
+inline T constrain(T amt, L low, H high) {
+  return amt < (T)low ? (T)low : (amt > (T)high ? (T)high : amt);
+}
+
+// --- String ---
+// Mirrors the ESP8266 core String closely enough for allocation counting:
+// short strings live in an inline buffer (SSO), longer ones go to the heap.
+class String {
+private:
+  enum { SSO_CAPACITY = 11 };
+
+  char sso[SSO_CAPACITY + 1];
+  char *heap;
+  unsigned int len;
+  unsigned int capacity;
+
+  char *buf() { return heap ? heap : sso; }
+  const char *buf() const { return heap ? heap : sso; }
+
+  void init() {
+    sso[0] = '\0';
+    heap = nullptr;
+    len = 0;
+    capacity = SSO_CAPACITY;
+  }
+
+  void copy(const char *cstr, unsigned int length) {
+    reserve(length);
+    memmove(buf(), cstr, length);
+    len = length;
+    buf()[len] = '\0';
+  }
+
+  void append(const char *cstr, unsigned int length) {
+    if (length == 0)
+      return;
+    reserve(len + length);
+    memmove(buf() + len, cstr, length);
+    len += length;
+    buf()[len] = '\0';
+  }
+
+public:
+  String() { init(); }
+  String(const char *cstr) {
+    init();
+    if (cstr)
+      copy(cstr, strlen(cstr));
+  }
+  String(const String &s) {
+    init();
+    copy(s.c_str(), s.len);
+  }
+  String(String &&s) noexcept {
+    init();
+    *this = static_cast<String &&>(s);
+  }
+  explicit String(char c) {
+    init();
+    copy(&c, 1);
+  }
+  explicit String(int v) {
+    init();
+    char tmp[16];
+    copy(tmp, snprintf(tmp, sizeof(tmp), "%d", v));
+  }
+  explicit String(unsigned int v) {
+    init();
+    char tmp[16];
+    copy(tmp, snprintf(tmp, sizeof(tmp), "%u", v));
+  }
+  explicit String(long v) {
+    init();
+    char tmp[24];
+    copy(tmp, snprintf(tmp, sizeof(tmp), "%ld", v));
+  }
+  explicit String(unsigned long v) {
+    init();
+    char tmp[24];
+    copy(tmp, snprintf(tmp, sizeof(tmp), "%lu", v));
+  }
+  explicit String(float v, unsigned char decimals = 2) {
+    init();
+    char tmp[32];
+    copy(tmp, snprintf(tmp, sizeof(tmp), "%.*f", decimals, v));
+  }
+  ~String() { delete[] heap; }
+
+  bool reserve(unsigned int size) {
+    if (size <= capacity)
+      return true;
+    char *grown = new char[size + 1];
+    memcpy(grown, buf(), len + 1);
+    delete[] heap;
+    heap = grown;
+    capacity = size;
+    return true;
+  }
+
+  String &operator=(const String &rhs) {
+    if (this != &rhs)
+      copy(rhs.c_str(), rhs.len);
+    return *this;
+  }
+  String &operator=(String &&rhs) noexcept {
+    if (this == &rhs)
+      return *this;
+    delete[] heap;
+    init();
+    if (rhs.heap) {
+      heap = rhs.heap;
+      capacity = rhs.capacity;
+      len = rhs.len;
+      rhs.init();
+    } else {
+      copy(rhs.sso, rhs.len);
+      rhs.len = 0;
+      rhs.sso[0] = '\0';
+    }
+    return *this;
+  }
+  String &operator=(const char *cstr) {
+    if (cstr)
+      copy(cstr, strlen(cstr));
+    else
+      copy("", 0);
+    return *this;
+  }
+
+  String &operator+=(const String &rhs) {
+    append(rhs.c_str(), rhs.len);
+    return *this;
+  }
+  String &operator+=(const char *cstr) {
+    if (cstr)
+      append(cstr, strlen(cstr));
+    return *this;
+  }
+  String &operator+=(char c) {
+    append(&c, 1);
+    return *this;
+  }
+
+  friend String operator+(const String &lhs, const String &rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+  }
+  friend String operator+(const String &lhs, const char *rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+  }
+  friend String operator+(const char *lhs, const String &rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+  }
+
+  bool operator==(const String &rhs) const {
+    return len == rhs.len && strcmp(c_str(), rhs.c_str()) == 0;
+  }
+  bool operator==(const char *cstr) const {
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+  }
+  bool operator!=(const String &rhs) const { return !(*this == rhs); }
+  bool operator!=(const char *cstr) const { return !(*this == cstr); }
+
+  char operator[](unsigned int index) const {
+    return index < len ? buf()[index] : '\0';
+  }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  const char *c_str() const { return buf(); }
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+
+  int indexOf(char c, unsigned int from = 0) const {
+    if (from >= len)
+      return -1;
+    const char *hit = strchr(c_str() + from, c);
+    return hit ? (int)(hit - c_str()) : -1;
+  }
+  int indexOf(const char *s, unsigned int from = 0) const {
+    if (from >= len)
+      return -1;
+    const char *hit = strstr(c_str() + from, s);
+    return hit ? (int)(hit - c_str()) : -1;
+  }
+
+  String substring(unsigned int left) const { return substring(left, len); }
+  String substring(unsigned int left, unsigned int right) const {
+    if (left > right)
+      std::swap(left, right);
+    String out;
+    if (left >= len)
+      return out;
+    if (right > len)
+      right = len;
+    out.copy(c_str() + left, right - left);
+    return out;
+  }
+
+  bool startsWith(const char *prefix) const {
+    size_t n = strlen(prefix);
+    return n <= len && strncmp(c_str(), prefix, n) == 0;
+  }
+  bool startsWith(const String &prefix) const {
+    return startsWith(prefix.c_str());
+  }
+
+  void toLowerCase() {
+    for (unsigned int i = 0; i < len; i++)
+      buf()[i] = (char)tolower((unsigned char)buf()[i]);
+  }
+
+  long toInt() const { return atol(c_str()); }
+  float toFloat() const { return (float)atof(c_str()); }
+};
+
+// --- Serial ---
+class HardwareSerial {
+public:
+  bool quiet = true; // Benchmarks keep stdout clean unless asked
+
+  void begin(unsigned long) {}
+  size_t print(const char *s) { return quiet ? 0 : (size_t)fputs(s, stdout); }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t println() { return print("\n"); }
+  size_t println(const char *s) { return print(s) + println(); }
+  size_t println(const String &s) { return println(s.c_str()); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    if (quiet)
+      return 0;
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n < 0 ? 0 : (size_t)n;
+  }
+};
+
+inline HardwareSerial Serial;
+
+#endif
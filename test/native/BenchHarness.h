@@ -0,0 +1,76 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// Shared timing / allocation counting for the native benchmark suites.
+// Include from exactly one translation unit per test binary: it replaces
+// the global operator new/delete to count heap allocations.
+//
+// Every result is printed as one machine-readable line:
+//   BENCH,<suite>,<case>,<ns per iteration>,<allocations per iteration>
+// so successive runs can be diffed or collected by CI.
+
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+
+namespace BenchHarness {
+inline unsigned long allocations = 0;
+inline unsigned long allocatedBytes = 0;
+
+// Keeps the optimizer from discarding work whose results are never read
+template <typename T> inline void doNotOptimize(T &value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+  double nsPerIter;
+  double allocsPerIter;
+  double bytesPerIter;
+};
+
+// Runs fn() `iterations` times after a short warm-up. `frameMs` is added
+// to the mock clock before every call so animations keep progressing.
+template <typename Fn>
+Result run(const char *suite, const char *name, int iterations, Fn fn,
+           unsigned long frameMs = 0) {
+  for (int i = 0; i < iterations / 10 + 1; i++) {
+    ArduinoMock::advanceMillis(frameMs);
+    fn();
+  }
+
+  unsigned long allocStart = allocations;
+  unsigned long bytesStart = allocatedBytes;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    ArduinoMock::advanceMillis(frameMs);
+    fn();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  Result r;
+  r.nsPerIter =
+      std::chrono::duration<double, std::nano>(end - start).count() /
+      iterations;
+  r.allocsPerIter = (double)(allocations - allocStart) / iterations;
+  r.bytesPerIter = (double)(allocatedBytes - bytesStart) / iterations;
+  printf("BENCH,%s,%s,%.1f,%.2f\n", suite, name, r.nsPerIter,
+         r.allocsPerIter);
+  return r;
+}
+} // namespace BenchHarness
+
+void *operator new(size_t size) {
+  BenchHarness::allocations++;
+  BenchHarness::allocatedBytes += size;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+#endif
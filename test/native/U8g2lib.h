@@ -0,0 +1,340 @@
+#ifndef U8G2LIB_STUB_H
+#define U8G2LIB_STUB_H
+
+// Host-side stand-in for U8g2, used by [env:native].
+// Renders into an in-memory SSD1306 style framebuffer (128x64, 1 bpp,
+// 8-pixel vertical pages) and counts the work done so benchmarks can report
+// pixel writes and bytes that would have gone over I2C. The buffer holds
+// the whole frame (_F_) or one or two pages of it (_1_/_2_, page mode),
+// and what was sent is kept as the panel image.
+// Disc/line rasterization follows the U8g2 algorithms; fonts are
+// fixed-width placeholder glyphs with the real fonts' advance widths.
+
+#include <Arduino.h>
+
+#define U8X8_PIN_NONE 255
+
+// Code that writes the buffer itself (EyeSpriteCache::blit) reports the
+// bytes here, so its work is counted like the drawing calls'
+#define U8G2_COUNT_BUFFER_WRITES(u8g2, n) ((u8g2).stats.bufferWrites += (n))
+
+typedef struct u8g2_cb_struct {
+  int unused;
+} u8g2_cb_t;
+
+inline const u8g2_cb_t u8g2_cb_r0 = {0};
+#define U8G2_R0 (&u8g2_cb_r0)
+
+// Font descriptors: {glyph advance, ascent}
+static const uint8_t u8g2_font_tom_thumb_4x6_t_all[] = {4, 5};
+static const uint8_t u8g2_font_profont12_tf[] = {6, 8};
+static const uint8_t u8g2_font_profont17_tf[] = {9, 11};
+static const uint8_t u8g2_font_profont29_tf[] = {16, 19};
+
+class U8G2 {
+public:
+  enum { WIDTH = 128, HEIGHT = 64, TILE_WIDTH = WIDTH / 8 };
+
+  // Work counters, reset by the tests between measurements
+  struct Stats {
+    unsigned long pixelWrites;
+    unsigned long drawCalls;
+    unsigned long bufferWrites; // Bytes stored through getBufferPtr()
+    unsigned long fullFlushes;
+    unsigned long areaFlushes;
+    unsigned long bytesSent;
+  };
+  Stats stats;
+
+private:
+  uint8_t buffer[WIDTH * HEIGHT / 8]; // Only bufferTileRows pages are used
+  uint8_t panel[WIDTH * HEIGHT / 8];  // What the display shows
+  uint8_t bufferTileRows;
+  uint8_t currTileRow; // First page the buffer covers
+  uint8_t drawColor;
+  uint8_t fontMode;
+  uint8_t bitmapMode;
+  const uint8_t *font;
+
+public:
+  U8G2(uint8_t tileRows = HEIGHT / 8)
+      : bufferTileRows(tileRows), currTileRow(0), drawColor(1), fontMode(0),
+        bitmapMode(0), font(nullptr) {
+    memset(buffer, 0, sizeof(buffer));
+    memset(panel, 0, sizeof(panel));
+    resetStats();
+  }
+
+  bool begin() { return true; }
+
+  // --- Buffer ---
+  void clearBuffer() { memset(buffer, 0, bufferBytes()); }
+  // Sends the buffer to the pages it covers (all of them with _F_)
+  void sendBuffer() {
+    stats.fullFlushes++;
+    stats.bytesSent += bufferBytes();
+    memcpy(panel + currTileRow * WIDTH, buffer, bufferBytes());
+  }
+  // Full buffer mode only, as on the device
+  void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    stats.areaFlushes++;
+    stats.bytesSent += (unsigned long)tw * th * 8;
+    for (int row = ty; row < ty + th; row++)
+      memcpy(panel + row * WIDTH + tx * 8, buffer + row * WIDTH + tx * 8,
+             tw * 8);
+  }
+  uint8_t *getBufferPtr() { return buffer; }
+  uint8_t getBufferTileWidth() const { return TILE_WIDTH; }
+  uint8_t getBufferTileHeight() const { return bufferTileRows; }
+  uint8_t getBufferCurrTileRow() const { return currTileRow; }
+  // Page mode: point the buffer at another band of pages; drawing is
+  // clipped to it
+  void setBufferCurrTileRow(uint8_t row) { currTileRow = row; }
+  int getDisplayWidth() const { return WIDTH; }
+  int getDisplayHeight() const { return HEIGHT; }
+
+  // --- State ---
+  void setDrawColor(uint8_t c) { drawColor = c; }
+  uint8_t getDrawColor() const { return drawColor; }
+  void setFontMode(uint8_t m) { fontMode = m; }
+  void setBitmapMode(uint8_t m) { bitmapMode = m; }
+  void setFont(const uint8_t *f) { font = f; }
+
+  // --- Pixels ---
+  void drawPixel(int x, int y) { plot(x, y, drawColor); }
+
+  // Buffer contents, in display coordinates (false outside the band)
+  bool getPixel(int x, int y) const {
+    int row = y - currTileRow * 8;
+    if (x < 0 || row < 0 || x >= WIDTH || row >= bufferTileRows * 8)
+      return false;
+    return buffer[(row >> 3) * WIDTH + x] & (1 << (row & 7));
+  }
+
+  void drawHLine(int x, int y, int w) {
+    stats.drawCalls++;
+    for (int i = 0; i < w; i++)
+      plot(x + i, y, drawColor);
+  }
+
+  void drawVLine(int x, int y, int h) {
+    stats.drawCalls++;
+    for (int i = 0; i < h; i++)
+      plot(x, y + i, drawColor);
+  }
+
+  void drawBox(int x, int y, int w, int h) {
+    stats.drawCalls++;
+    for (int j = 0; j < h; j++)
+      for (int i = 0; i < w; i++)
+        plot(x + i, y + j, drawColor);
+  }
+
+  void drawFrame(int x, int y, int w, int h) {
+    drawHLine(x, y, w);
+    drawHLine(x, y + h - 1, w);
+    drawVLine(x, y, h);
+    drawVLine(x + w - 1, y, h);
+  }
+
+  void drawRFrame(int x, int y, int w, int h, int /* r */) {
+    drawFrame(x, y, w, h);
+  }
+
+  void drawLine(int x1, int y1, int x2, int y2) {
+    stats.drawCalls++;
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+      plot(x1, y1, drawColor);
+      if (x1 == x2 && y1 == y2)
+        break;
+      int e2 = 2 * err;
+      if (e2 >= dy) {
+        err += dy;
+        x1 += sx;
+      }
+      if (e2 <= dx) {
+        err += dx;
+        y1 += sy;
+      }
+    }
+  }
+
+  // Same midpoint walk as u8g2_DrawDisc
+  void drawDisc(int x0, int y0, int rad) {
+    stats.drawCalls++;
+    int f = 1 - rad;
+    int ddF_x = 1;
+    int ddF_y = -2 * rad;
+    int x = 0;
+    int y = rad;
+    discSection(x, y, x0, y0);
+    while (x < y) {
+      if (f >= 0) {
+        y--;
+        ddF_y += 2;
+        f += ddF_y;
+      }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+      discSection(x, y, x0, y0);
+    }
+  }
+
+  void drawFilledEllipse(int x0, int y0, int rx, int ry) {
+    stats.drawCalls++;
+    for (int dy = -ry; dy <= ry; dy++)
+      for (int dx = -rx; dx <= rx; dx++)
+        if ((long)dx * dx * ry * ry + (long)dy * dy * rx * rx <=
+            (long)rx * rx * ry * ry)
+          plot(x0 + dx, y0 + dy, drawColor);
+  }
+
+  // Scanline fill, sampling pixel centres
+  void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2) {
+    stats.drawCalls++;
+    int minY = std::min(y0, std::min(y1, y2));
+    int maxY = std::max(y0, std::max(y1, y2));
+    minY = std::max(minY, 0);
+    maxY = std::min(maxY, HEIGHT - 1);
+    const int xs[3] = {x0, x1, x2};
+    const int ys[3] = {y0, y1, y2};
+    for (int y = minY; y <= maxY; y++) {
+      int left = WIDTH, right = -1;
+      for (int e = 0; e < 3; e++) {
+        int ax = xs[e], ay = ys[e];
+        int bx = xs[(e + 1) % 3], by = ys[(e + 1) % 3];
+        if (ay == by) {
+          if (ay == y) {
+            left = std::min(left, std::min(ax, bx));
+            right = std::max(right, std::max(ax, bx));
+          }
+          continue;
+        }
+        if (y < std::min(ay, by) || y > std::max(ay, by))
+          continue;
+        int x = ax + (int)lround((double)(y - ay) * (bx - ax) / (by - ay));
+        left = std::min(left, x);
+        right = std::max(right, x);
+      }
+      for (int x = left; x <= right; x++)
+        plot(x, y, drawColor);
+    }
+  }
+
+  // XBM: row-major, LSB first, rows padded to whole bytes
+  void drawXBM(int x, int y, int w, int h, const uint8_t *bitmap) {
+    stats.drawCalls++;
+    int stride = (w + 7) / 8;
+    for (int j = 0; j < h; j++) {
+      for (int i = 0; i < w; i++) {
+        bool on = bitmap[j * stride + (i >> 3)] & (1 << (i & 7));
+        if (on)
+          plot(x + i, y + j, drawColor);
+        else if (bitmapMode == 0)
+          plot(x + i, y + j, drawColor == 0 ? 1 : 0);
+      }
+    }
+  }
+
+  // --- Text ---
+  int getStrWidth(const char *s) const {
+    return font ? (int)strlen(s) * font[0] : 0;
+  }
+
+  int drawStr(int x, int y, const char *s) {
+    stats.drawCalls++;
+    if (!font)
+      return 0;
+    int advance = font[0];
+    int ascent = font[1];
+    for (const char *c = s; *c; c++, x += advance) {
+      if (*c == ' ')
+        continue;
+      // Placeholder glyph: the character code as a column pattern
+      for (int gx = 0; gx < advance - 1; gx++) {
+        uint8_t bits = (uint8_t)(*c * (gx + 1));
+        for (int gy = 0; gy < ascent; gy++)
+          if (bits & (1 << (gy & 7)))
+            plot(x + gx, y - ascent + gy, drawColor);
+      }
+    }
+    return (int)strlen(s) * advance;
+  }
+
+  // --- Host Helpers ---
+  void resetStats() { memset(&stats, 0, sizeof(stats)); }
+
+  int bufferBytes() const { return bufferTileRows * WIDTH; }
+
+  // The frame as last sent to the panel, same layout as a full buffer
+  const uint8_t *getPanelPtr() const { return panel; }
+  void clearPanel() { memset(panel, 0, sizeof(panel)); }
+
+private:
+  void plot(int x, int y, uint8_t color) {
+    y -= currTileRow * 8;
+    if (x < 0 || y < 0 || x >= WIDTH || y >= bufferTileRows * 8)
+      return;
+    stats.pixelWrites++;
+    uint8_t &b = buffer[(y >> 3) * WIDTH + x];
+    uint8_t mask = 1 << (y & 7);
+    if (color == 0)
+      b &= ~mask;
+    else if (color == 1)
+      b |= mask;
+    else
+      b ^= mask;
+  }
+
+  void discSection(int x, int y, int x0, int y0) {
+    // upper right / upper left
+    vline(x0 + x, y0 - y, y + 1);
+    vline(x0 + y, y0 - x, x + 1);
+    vline(x0 - x, y0 - y, y + 1);
+    vline(x0 - y, y0 - x, x + 1);
+    // lower right / lower left
+    vline(x0 + x, y0, y + 1);
+    vline(x0 + y, y0, x + 1);
+    vline(x0 - x, y0, y + 1);
+    vline(x0 - y, y0, x + 1);
+  }
+
+  void vline(int x, int y, int h) {
+    for (int i = 0; i < h; i++)
+      plot(x, y + i, drawColor);
+  }
+};
+
+// Display constructors used by main.cpp: full buffer (_F_) and page
+// buffers of one (_1_) or two (_2_) pages. The pins are ignored on the host.
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t * /* rotation */,
+                                      uint8_t /* reset */ = U8X8_PIN_NONE,
+                                      uint8_t /* clock */ = U8X8_PIN_NONE,
+                                      uint8_t /* data */ = U8X8_PIN_NONE) {}
+};
+
+class U8G2_SSD1306_128X64_NONAME_1_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_1_HW_I2C(const u8g2_cb_t * /* rotation */,
+                                      uint8_t /* reset */ = U8X8_PIN_NONE,
+                                      uint8_t /* clock */ = U8X8_PIN_NONE,
+                                      uint8_t /* data */ = U8X8_PIN_NONE)
+      : U8G2(1) {}
+};
+
+class U8G2_SSD1306_128X64_NONAME_2_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_2_HW_I2C(const u8g2_cb_t * /* rotation */,
+                                      uint8_t /* reset */ = U8X8_PIN_NONE,
+                                      uint8_t /* clock */ = U8X8_PIN_NONE,
+                                      uint8_t /* data */ = U8X8_PIN_NONE)
+      : U8G2(2) {}
+};
+
+#endif
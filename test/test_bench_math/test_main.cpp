@@ -0,0 +1,125 @@
+// Float vs fixed-point kernels used by Eye animation.
+// Run with: pio test -e native -f test_bench_math -v
+//
+// The host has a hardware FPU, so the gap here understates the ESP8266,
+// where every float operation is a software routine.
+
+#include <BenchHarness.h>
+#include <unity.h>
+
+#include "Math/FixedPoint.h"
+
+static const int ITERATIONS = 200000;
+
+static volatile int sinkInt;
+static volatile float sinkFloat;
+
+void setUp() { ArduinoMock::reset(); }
+
+void tearDown() {}
+
+void test_lerp_five_params() {
+  float fa[5] = {-0.8, 0.2, 1.2, 1.2, 1.0};
+  float fb[5] = {0.5, -0.8, 0.5, 0.8, 0.5};
+  fix8_t xa[5], xb[5];
+  for (int i = 0; i < 5; i++) {
+    xa[i] = (fix8_t)(fa[i] * FIX8_ONE);
+    xb[i] = (fix8_t)(fb[i] * FIX8_ONE);
+  }
+
+  unsigned long step = 0;
+  BenchHarness::run("math", "lerp5_float", ITERATIONS, [&]() {
+    float t = (float)(step++ % 500) / 500;
+    float acc = 0;
+    for (int i = 0; i < 5; i++)
+      acc += fa[i] + (fb[i] - fa[i]) * t;
+    sinkFloat = acc;
+  });
+
+  step = 0;
+  BenchHarness::run("math", "lerp5_fixed", ITERATIONS, [&]() {
+    fix8_t t = (fix8_t)(((step++ % 500) << FIX8_SHIFT) / 500);
+    fix8_t acc = 0;
+    for (int i = 0; i < 5; i++)
+      acc += fix8Lerp(xa[i], xb[i], t);
+    sinkInt = acc;
+  });
+}
+
+void test_bounce_sine() {
+  unsigned long ms = 0;
+  BenchHarness::run("math", "bounce_float_sin", ITERATIONS, [&]() {
+    sinkInt = (int)(sin(ms++ / 50.0) * 1.5);
+  });
+
+  ms = 0;
+  BenchHarness::run("math", "bounce_lut_sin", ITERATIONS, [&]() {
+    sinkInt = (sinLutQ14(msToBinaryAngle(ms++, 53404)) * 3) / (2 << 14);
+  });
+
+  // LUT accuracy: quarter-wave table with 64 steps
+  for (int a = 0; a < 256; a++) {
+    double expected = sin(a * 2 * M_PI / 256);
+    double actual = sinLutQ14(a) / 16384.0;
+    TEST_ASSERT_TRUE(fabs(expected - actual) < 0.001);
+  }
+}
+
+void test_look_at_sqrt() {
+  int n = 0;
+  BenchHarness::run("math", "lookat_float_sqrt", ITERATIONS, [&]() {
+    int dx = (n % 97) - 48, dy = (n % 61) - 30;
+    n++;
+    float dist = sqrt(dx * dx + dy * dy);
+    sinkInt = dist > 6 ? (int)(dx * (6 / dist)) : dx;
+  });
+
+  n = 0;
+  BenchHarness::run("math", "lookat_isqrt", ITERATIONS, [&]() {
+    int dx = (n % 97) - 48, dy = (n % 61) - 30;
+    n++;
+    uint32_t distSq = dx * dx + dy * dy;
+    sinkInt = distSq > 36 ? dx * 6 / (int)isqrt32(distSq) : dx;
+  });
+
+  for (uint32_t v = 0; v < 100000; v += 7) {
+    uint32_t r = isqrt32(v);
+    TEST_ASSERT_TRUE(r * r <= v && (r + 1) * (r + 1) > v);
+  }
+}
+
+void test_constants_land_on_exact_rows() {
+  // Every eyelid constant (in tenths) times the eye radius must truncate to
+  // the exact decimal row. Float only gets there for some radii: at r = 25,
+  // 25 * -1.2f comes out a hair above -30 and loses a row.
+  const int tenths[] = {-12, -8, -5, -1, 1, 2, 5, 8, 10, 12};
+  for (int c : tenths) {
+    for (int r = 4; r <= 30; r++) {
+      for (int cy = r; cy < 64; cy += 7) {
+        int exact10 = cy * 10 + r * c;
+        if (exact10 < 0)
+          continue; // Off-screen rows aren't drawn
+        int actual = fix8ToInt(cy * FIX8_ONE + r * fix8FromFloat(c / 10.0f));
+        TEST_ASSERT_EQUAL(exact10 / 10, actual);
+      }
+    }
+  }
+
+  // At the firmware's radius both paths agree
+  for (int c : tenths) {
+    for (int cy = 24; cy < 64; cy++) {
+      int floatRow = cy + (20 * (c / 10.0f));
+      fix8_t q = fix8FromFloat(c / 10.0f);
+      TEST_ASSERT_EQUAL(floatRow, fix8ToInt(cy * FIX8_ONE + 20 * q));
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_lerp_five_params);
+  RUN_TEST(test_bounce_sine);
+  RUN_TEST(test_look_at_sqrt);
+  RUN_TEST(test_constants_land_on_exact_rows);
+  return UNITY_END();
+}
@@ -0,0 +1,328 @@
+// Frame-render benchmarks for the native host build.
+// Run with: pio test -e native -f test_bench_render -v
+
+#include <BenchHarness.h>
+#include <unity.h>
+
+#include "Face/Eye.h"
+#include "Manager/JumboController.h"
+#include "Sequence/SequenceQueue.h"
+#include "TextBox.h"
+
+static const int ITERATIONS = 2000;
+
+static const Eye::Expression EXPRESSIONS[] = {
+    Eye::EXPR_ANGRY, Eye::EXPR_HAPPY, Eye::EXPR_SHOCKED,
+    Eye::EXPR_SAD,   Eye::EXPR_CALM,  Eye::EXPR_SLEEP};
+static const char *EXPRESSION_NAMES[] = {"angry", "happy", "shocked",
+                                         "sad",   "calm",  "sleep"};
+static const int EXPRESSION_COUNT = 6;
+
+static U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE, D1,
+                                                D2);
+
+void setUp() {
+  ArduinoMock::reset();
+  u8g2.clearBuffer();
+  u8g2.resetStats();
+}
+
+void tearDown() {}
+
+void test_eye_draw_per_expression() {
+  for (int i = 0; i < EXPRESSION_COUNT; i++) {
+    Eye eye(32, 26, 20, true);
+    eye.setExpression(EXPRESSIONS[i], 0);
+    eye.update();
+
+    char name[32];
+    snprintf(name, sizeof(name), "eye_draw_%s", EXPRESSION_NAMES[i]);
+    BenchHarness::Result r = BenchHarness::run(
+        "render", name, ITERATIONS, [&]() { eye.draw(u8g2); }, 16);
+    TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+  }
+}
+
+void test_eye_draw_sprite_per_expression() {
+  static EyeSpriteCache cache;
+  for (int i = 0; i < EXPRESSION_COUNT; i++) {
+    Eye eye(32, 26, 20, true);
+    eye.buildSprites(u8g2, cache);
+    eye.setExpression(EXPRESSIONS[i], 0);
+    eye.update();
+
+    char name[40];
+    snprintf(name, sizeof(name), "eye_draw_sprite_%s", EXPRESSION_NAMES[i]);
+    BenchHarness::Result r = BenchHarness::run(
+        "render", name, ITERATIONS, [&]() { eye.draw(u8g2); }, 16);
+    TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+  }
+}
+
+// The cached path must produce exactly the pixels of live rasterization
+void test_eye_sprite_matches_live() {
+  static EyeSpriteCache cache;
+  static uint8_t live[1024];
+  const float blinks[] = {0.0, 0.3, 0.75, 1.0};
+
+  for (int side = 0; side < 2; side++) {
+    Eye eye(side ? 96 : 32, 26, 20, side == 0);
+    eye.buildSprites(u8g2, cache);
+    for (int i = 0; i < EXPRESSION_COUNT; i++) {
+      eye.setExpression(EXPRESSIONS[i], 0);
+      for (float blink : blinks) {
+        for (int bounce = -1; bounce <= 1; bounce++) {
+          eye.blinkPercent = EYE_PARAM(blink);
+          eye.bounceY = bounce;
+
+          u8g2.clearBuffer();
+          eye.drawLive(u8g2);
+          memcpy(live, u8g2.getBufferPtr(), sizeof(live));
+
+          u8g2.clearBuffer();
+          eye.draw(u8g2);
+          TEST_ASSERT_EQUAL_MEMORY(live, u8g2.getBufferPtr(), sizeof(live));
+        }
+      }
+    }
+  }
+}
+
+void test_eye_update_per_expression() {
+  for (int i = 0; i < EXPRESSION_COUNT; i++) {
+    Eye eye(32, 26, 20, true);
+    // Keep the eye morphing between two expressions for the whole run
+    Eye::Expression from = EXPRESSIONS[(i + 1) % EXPRESSION_COUNT];
+    eye.setExpression(from, 0);
+    eye.setExpression(EXPRESSIONS[i], ITERATIONS * 32);
+
+    char name[32];
+    snprintf(name, sizeof(name), "eye_update_%s", EXPRESSION_NAMES[i]);
+    BenchHarness::Result r = BenchHarness::run(
+        "render", name, ITERATIONS, [&]() {
+          eye.update();
+          BenchHarness::doNotOptimize(eye);
+        },
+        16);
+    TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+  }
+}
+
+void test_eye_update_blinking() {
+  Eye eye(32, 26, 20, true);
+  eye.setExpression(Eye::EXPR_CALM, 0);
+  BenchHarness::run(
+      "render", "eye_update_blink", ITERATIONS,
+      [&]() {
+        eye.blink();
+        eye.update();
+        BenchHarness::doNotOptimize(eye);
+      },
+      16);
+}
+
+void test_textbox_draw() {
+  TextBox single(0, 0, 12, 0, ALIGN_LEFT);
+  single.setText("Sleeping...");
+  BenchHarness::Result r = BenchHarness::run(
+      "render", "textbox_single_line", ITERATIONS,
+      [&]() { single.draw(u8g2); });
+  TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+
+  TextBox wrapped(0, 0, 12, 128, ALIGN_CENTER);
+  wrapped.setText("The quick brown fox jumps over the lazy dog again");
+  r = BenchHarness::run("render", "textbox_wrapped", ITERATIONS,
+                        [&]() { wrapped.draw(u8g2); });
+  TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+
+  // Worst case: new text every frame forces a fresh layout
+  const char *captions[] = {"The quick brown fox jumps over the lazy dog",
+                            "Pack my box with five dozen liquor jugs"};
+  int frame = 0;
+  BenchHarness::run("render", "textbox_wrapped_relayout", ITERATIONS, [&]() {
+    wrapped.setText(captions[frame++ & 1]);
+    wrapped.draw(u8g2);
+  });
+}
+
+// Queues a long-running step so the controller holds the expression
+// instead of falling back to sleep on an empty queue.
+static void playStep(JumboController &controller, SequenceQueue &queue,
+                     Eye::Expression expression, const char *text) {
+  SequenceStep step;
+  step.expression = expression;
+  step.setText(text);
+  step.beepMs = 0;
+  step.soundPattern = SOUND_NONE;
+  step.displayMs = 3600000;
+  queue.clear();
+  queue.add(step);
+  controller.update();
+  ArduinoMock::advanceMillis(600); // Let the morph finish
+  controller.update();
+}
+
+void test_controller_draw_per_expression() {
+  for (int i = 0; i < EXPRESSION_COUNT; i++) {
+    SequenceQueue queue;
+    JumboController controller(u8g2, queue, D5);
+    controller.begin();
+    playStep(controller, queue, EXPRESSIONS[i], "Hello there!");
+
+    char name[40];
+    snprintf(name, sizeof(name), "controller_draw_%s", EXPRESSION_NAMES[i]);
+    u8g2.resetStats();
+    BenchHarness::run(
+        "render", name, ITERATIONS,
+        [&]() {
+          controller.update();
+          controller.draw();
+        },
+        16);
+    printf("BENCH_I2C,render,%s,%.1f\n", name,
+           (double)u8g2.stats.bytesSent /
+               (ITERATIONS + ITERATIONS / 10 + 1));
+  }
+}
+
+void test_controller_flush_idle_frames() {
+  SequenceQueue queue;
+  JumboController controller(u8g2, queue, D5);
+  controller.begin();
+  playStep(controller, queue, Eye::EXPR_CALM, "Hello there!");
+  controller.draw(); // Full frame after begin()
+
+  // An unchanged frame must not touch the bus
+  u8g2.resetStats();
+  controller.draw();
+  TEST_ASSERT_EQUAL(0, u8g2.stats.bytesSent);
+
+  // Playback with the occasional blink: only eye tiles get sent
+  const int frames = 600;
+  u8g2.resetStats();
+  for (int i = 0; i < frames; i++) {
+    ArduinoMock::advanceMillis(16);
+    controller.update();
+    controller.draw();
+  }
+  printf("BENCH_I2C,render,controller_idle_calm,%.1f\n",
+         (double)u8g2.stats.bytesSent / frames);
+  TEST_ASSERT_GREATER_THAN(0, u8g2.stats.areaFlushes);
+  TEST_ASSERT_LESS_THAN(1024UL * frames / 4, u8g2.stats.bytesSent);
+}
+
+// Short steps cycling through every expression with wrapped captions.
+// Tops the queue up when it runs low; `next` counts the steps queued.
+static void queuePlayback(SequenceQueue &queue, int &next) {
+  static const char *captions[] = {
+      "The quick brown fox jumps over the lazy dog",
+      "Pack my box with five dozen liquor jugs",
+      "How vexingly quick daft zebras jump"};
+  if (queue.size() >= 4) {
+    return;
+  }
+  while (queue.freeSlots() > 0) {
+    SequenceStep step;
+    step.expression = EXPRESSIONS[next % EXPRESSION_COUNT];
+    step.setText(captions[next % 3]);
+    step.beepMs = next % 4 == 0 ? 50 : 0;
+    step.soundPattern = SOUND_NONE;
+    step.displayMs = 200;
+    queue.add(step);
+    next++;
+  }
+}
+
+// One playback frame; uneven frame times, 16..33 ms
+static void playbackFrame(JumboController &controller, SequenceQueue &queue,
+                          int &next, int &frame) {
+  queuePlayback(queue, next);
+  controller.update();
+  controller.draw();
+  ArduinoMock::advanceMillis(16 + (frame++ * 7) % 18);
+}
+
+// Steady-state playback (steps changing, captions re-wrapping, eyes
+// morphing and blinking) must not touch the heap at all
+void test_playback_zero_alloc() {
+  SequenceQueue queue;
+  JumboController controller(u8g2, queue, D5);
+  controller.begin();
+
+  int next = 0;
+  int frame = 0;
+  playbackFrame(controller, queue, next, frame);
+  BenchHarness::Result r = BenchHarness::run(
+      "render", "playback_steady_state", ITERATIONS,
+      [&]() { playbackFrame(controller, queue, next, frame); });
+  TEST_ASSERT_GREATER_THAN(ITERATIONS / 10, next); // Steps really changed
+  TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+}
+
+static const int BACKEND_CHECK_FRAMES = 400;
+
+static uint32_t panelHash(const U8G2 &display) {
+  const uint8_t *p = display.getPanelPtr();
+  uint32_t h = 2166136261UL;
+  for (int i = 0; i < U8G2::WIDTH * U8G2::HEIGHT / 8; i++)
+    h = (h ^ p[i]) * 16777619UL;
+  return h;
+}
+
+// The same playback on one display backend (DisplayBackend.h): records
+// what reached the panel after every frame, then measures the frame cost,
+// the bytes sent and the RAM the buffer and flusher need.
+template <typename Display>
+static void runBackend(const char *name, uint32_t *frameHashes) {
+  ArduinoMock::reset();
+  Display display(U8G2_R0, U8X8_PIN_NONE, D1, D2);
+  SequenceQueue queue;
+  JumboController controller(display, queue, D5);
+  controller.begin();
+
+  int next = 0;
+  int frame = 0;
+  for (int i = 0; i < BACKEND_CHECK_FRAMES; i++) {
+    playbackFrame(controller, queue, next, frame);
+    frameHashes[i] = panelHash(display);
+  }
+
+  char bench[40];
+  snprintf(bench, sizeof(bench), "backend_%s", name);
+  display.resetStats();
+  BenchHarness::Result r = BenchHarness::run(
+      "render", bench, ITERATIONS,
+      [&]() { playbackFrame(controller, queue, next, frame); });
+  TEST_ASSERT_EQUAL(0, r.allocsPerIter);
+  printf("BENCH_I2C,render,%s,%.1f\n", bench,
+         (double)display.stats.bytesSent / (ITERATIONS + ITERATIONS / 10 + 1));
+  printf("BENCH_RAM,render,%s,%d\n", bench,
+         display.bufferBytes() + FrameFlusher::shadowBytes(display));
+}
+
+// Full buffer vs one- and two-page buffers: identical pictures on the panel
+void test_display_backends() {
+  static uint32_t full[BACKEND_CHECK_FRAMES];
+  static uint32_t paged[BACKEND_CHECK_FRAMES];
+
+  runBackend<U8G2_SSD1306_128X64_NONAME_F_HW_I2C>("full", full);
+  runBackend<U8G2_SSD1306_128X64_NONAME_2_HW_I2C>("page2", paged);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(full, paged, BACKEND_CHECK_FRAMES);
+  runBackend<U8G2_SSD1306_128X64_NONAME_1_HW_I2C>("page1", paged);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(full, paged, BACKEND_CHECK_FRAMES);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_eye_draw_per_expression);
+  RUN_TEST(test_eye_draw_sprite_per_expression);
+  RUN_TEST(test_eye_sprite_matches_live);
+  RUN_TEST(test_eye_update_per_expression);
+  RUN_TEST(test_eye_update_blinking);
+  RUN_TEST(test_textbox_draw);
+  RUN_TEST(test_controller_draw_per_expression);
+  RUN_TEST(test_controller_flush_idle_frames);
+  RUN_TEST(test_playback_zero_alloc);
+  RUN_TEST(test_display_backends);
+  return UNITY_END();
+}
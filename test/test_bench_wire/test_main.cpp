@@ -0,0 +1,343 @@
+// JSON vs packed binary step ingestion, plain and gzip-compressed: bytes on
+// the wire and decode cost.
+// Run with: pio test -e native -f test_bench_wire -v
+//
+// Every path is fed in HTTP_READ_CHUNK slices, the way APIClient receives
+// them. Bytes per batch print as BENCH_WIRE,wire,<format>,<bytes>.
+
+#include <BenchHarness.h>
+#include <unity.h>
+
+#include <ArduinoJson.h>
+#include <string>
+
+#include "Network/BinaryStepStream.h"
+#include "Network/JsonArrayStream.h"
+#include "Network/StreamInflater.h"
+#include "Sequence/StepBatch.h"
+
+static const int ITERATIONS = 2000;
+static const size_t CHUNK = 128; // HTTP_READ_CHUNK
+
+struct SampleStep {
+  const char *expression;
+  uint8_t expressionId;
+  int beepMs;
+  int displayMs;
+  const char *text;
+};
+
+// A typical batch from the server
+static const SampleStep BATCH[] = {
+    {"happy", 1, 100, 3000, "Good morning!"},
+    {"calm", 4, 0, 4000, "Coffee first, then code."},
+    {"shocked", 2, 500, 2000, "Is it Monday already?"},
+    {"sad", 3, 0, 3500, "The build is red."},
+    {"happy", 1, 100, 2500, "Fixed it."},
+    {"angry", 0, 300, 2000, "Who pushed to main?"},
+    {"calm", 4, 0, 5000, "Deep breath."},
+    {"happy", 1, 100, 3000, "Lunch time!"},
+    {"sleep", 5, 0, 6000, "Zzz..."},
+    {"shocked", 2, 200, 2000, "Meeting in 5 minutes!"}};
+static const int BATCH_SIZE = sizeof(BATCH) / sizeof(BATCH[0]);
+
+// The batch below, gzip-compressed with a 4 KB window (zlib level 9,
+// wbits 16 + 12), as a server would send it with Content-Encoding: gzip
+static const uint8_t JSON_BATCH_GZIP[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x93,
+    0xc1, 0x4a, 0xc4, 0x30, 0x10, 0x86, 0x5f, 0x65, 0xcc, 0xb9, 0x04, 0x6d,
+    0xad, 0x07, 0x2f, 0x82, 0x56, 0x45, 0x70, 0x6f, 0x0b, 0x82, 0xe2, 0x21,
+    0xdb, 0x4c, 0x37, 0x83, 0x6d, 0x12, 0x92, 0x14, 0xda, 0x8a, 0xef, 0x6e,
+    0xf0, 0xd2, 0x75, 0x1b, 0xd8, 0xc2, 0x1e, 0x33, 0x84, 0xef, 0xff, 0xf9,
+    0x32, 0xf9, 0xf8, 0x66, 0x8f, 0x83, 0x75, 0xe8, 0x3d, 0x19, 0xcd, 0x6e,
+    0x99, 0x12, 0xd6, 0x8e, 0x2c, 0x63, 0x5b, 0x1c, 0x42, 0x3c, 0x3e, 0x1b,
+    0x23, 0xa1, 0x33, 0x4e, 0x93, 0xde, 0x5f, 0xc4, 0xf1, 0x7d, 0x3f, 0x4d,
+    0xe8, 0xaa, 0xde, 0x89, 0xf0, 0x77, 0xff, 0x92, 0x5f, 0x65, 0xac, 0x22,
+    0x6f, 0x5b, 0x31, 0xce, 0xd3, 0xe2, 0x27, 0x3b, 0xc2, 0xd6, 0xa2, 0xed,
+    0x66, 0xea, 0x83, 0x69, 0x1a, 0x44, 0x68, 0xc8, 0xf9, 0x90, 0x41, 0x50,
+    0xa8, 0xa1, 0x36, 0x12, 0x79, 0x2a, 0x20, 0x81, 0xbf, 0x5e, 0xe0, 0xbd,
+    0x32, 0xf5, 0x17, 0xca, 0x39, 0xe1, 0xc5, 0x03, 0x05, 0xd8, 0x18, 0x2d,
+    0xc5, 0x08, 0xa2, 0x75, 0x28, 0xe4, 0x78, 0x97, 0xec, 0x5f, 0x26, 0x02,
+    0xf2, 0x65, 0x80, 0x38, 0x80, 0x6f, 0x15, 0xc2, 0xae, 0xa7, 0x56, 0x02,
+    0x79, 0x70, 0x28, 0xd7, 0xf6, 0x2e, 0x78, 0xb9, 0x00, 0x1f, 0xf9, 0x7e,
+    0xa2, 0x01, 0x23, 0x36, 0xf0, 0xd5, 0xae, 0xf3, 0x04, 0x54, 0xe8, 0xbd,
+    0x3b, 0x80, 0xbe, 0x29, 0x03, 0xb6, 0xf7, 0x2a, 0x92, 0x83, 0x81, 0x4e,
+    0x90, 0x4e, 0xab, 0x28, 0x56, 0xa9, 0xf8, 0xff, 0x94, 0x15, 0xa2, 0x85,
+    0x5d, 0xf4, 0x1b, 0xd4, 0x5a, 0x0d, 0x27, 0x25, 0xbc, 0xf6, 0xba, 0x56,
+    0x10, 0xa8, 0xc3, 0x73, 0x56, 0xce, 0xb7, 0xb1, 0xda, 0x0c, 0x7d, 0x9f,
+    0x26, 0xce, 0xd7, 0x56, 0xbc, 0x39, 0xbd, 0x61, 0x1b, 0xc4, 0x10, 0x3f,
+    0x05, 0x90, 0x86, 0x12, 0x3a, 0xd2, 0x7d, 0x40, 0x9f, 0xae, 0x9b, 0x27,
+    0xb5, 0x7e, 0xfe, 0x02, 0xb4, 0x92, 0x7e, 0x94, 0x7a, 0x03, 0x00, 0x00,};
+
+static const uint8_t BINARY_BATCH_GZIP[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x35, 0x8f,
+    0x4d, 0x4a, 0x03, 0x41, 0x10, 0x85, 0x5f, 0xc6, 0x68, 0x08, 0x49, 0x10,
+    0x09, 0x12, 0x97, 0x35, 0xfb, 0xd0, 0xbb, 0xac, 0xb3, 0x88, 0x28, 0x8a,
+    0x59, 0x29, 0x08, 0xee, 0x26, 0xe9, 0x1a, 0xbb, 0x20, 0xd3, 0x3d, 0x4c,
+    0xd7, 0x80, 0xc9, 0x09, 0x3c, 0x86, 0x07, 0xf0, 0x00, 0x1e, 0xc0, 0x85,
+    0x4b, 0x0f, 0x93, 0x03, 0xd8, 0x21, 0xb8, 0x7d, 0xbc, 0x9f, 0xef, 0xdd,
+    0x3f, 0x66, 0x1d, 0x0b, 0x7c, 0x0d, 0x80, 0xd1, 0x6d, 0x08, 0x96, 0xaa,
+    0xd0, 0x78, 0xf1, 0xaf, 0x79, 0x17, 0xc0, 0xc7, 0x39, 0x70, 0xb5, 0x08,
+    0x65, 0xc9, 0x4c, 0xa5, 0x34, 0x51, 0xa7, 0xa4, 0x8e, 0x3d, 0xad, 0x83,
+    0x65, 0x93, 0xed, 0x3b, 0xf8, 0xed, 0x01, 0x97, 0x77, 0x91, 0x44, 0x69,
+    0x19, 0xbc, 0x2d, 0xb6, 0x54, 0x6c, 0x1a, 0x2e, 0xec, 0x76, 0x7e, 0x92,
+    0xe2, 0x9f, 0x23, 0xe0, 0xe2, 0xc9, 0x31, 0xad, 0x5a, 0xd9, 0x58, 0x92,
+    0x48, 0x0d, 0x5b, 0x73, 0x98, 0xfb, 0xee, 0x03, 0xfd, 0x1b, 0x79, 0xe3,
+    0xa4, 0xaa, 0xc1, 0xf4, 0xd8, 0x34, 0x7e, 0x76, 0x81, 0xea, 0x36, 0xba,
+    0x24, 0x6b, 0xa0, 0xaa, 0x10, 0x3f, 0x3f, 0x60, 0xbc, 0x8f, 0x81, 0xe1,
+    0x35, 0x73, 0x4d, 0xab, 0x54, 0xae, 0xce, 0xfc, 0x13, 0x0f, 0x1e, 0x5a,
+    0xbf, 0x76, 0xa4, 0x52, 0x71, 0x7e, 0x9a, 0x8c, 0xf5, 0x04, 0x38, 0x7b,
+    0xd9, 0xed, 0x8c, 0x31, 0xd9, 0x0f, 0x8e, 0x74, 0x4b, 0x66, 0x4d, 0x7f,
+    0x48, 0x3c, 0xcd, 0xa8, 0x12, 0xdf, 0x2a, 0xc7, 0xfc, 0x0f, 0xd3, 0xab,
+    0xeb, 0x0c, 0xf6, 0x00, 0x00, 0x00,};
+
+// Raw deflate of 4132 'a's whose last match reaches back 4100 bytes, past
+// the 4 KB window: what a server on zlib's default 32 KB window can send
+static const uint8_t WIDE_WINDOW_DEFLATE[] = {
+    0x4b, 0x1c, 0x05, 0xa3, 0x60, 0x14, 0x8c, 0x82, 0x51, 0x30, 0x0a, 0x46,
+    0xc1, 0x28, 0x18, 0x05, 0xa3, 0x60, 0x14, 0x8c, 0x82, 0x51, 0x30, 0x0a,
+    0x46, 0xc1, 0x28, 0x00, 0x8e, 0x01, 0x00, 0x00};
+
+static std::string jsonBody;
+static std::string binaryBody;
+
+static void buildBodies() {
+  char buf[160];
+  jsonBody = "[";
+  for (int i = 0; i < BATCH_SIZE; i++) {
+    const SampleStep &s = BATCH[i];
+    snprintf(buf, sizeof(buf),
+             "%s{\"Expression\":\"%s\",\"Text\":\"%s\","
+             "\"BuzzerDuration\":%g,\"DisplayDuration\":%g}",
+             i ? "," : "", s.expression, s.text, s.beepMs / 1000.0,
+             s.displayMs / 1000.0);
+    jsonBody += buf;
+  }
+  jsonBody += "]";
+
+  binaryBody = std::string("JS") + (char)STEP_WIRE_VERSION;
+  for (int i = 0; i < BATCH_SIZE; i++) {
+    const SampleStep &s = BATCH[i];
+    binaryBody += (char)s.expressionId;
+    binaryBody += (char)(s.beepMs & 0xFF);
+    binaryBody += (char)(s.beepMs >> 8);
+    binaryBody += (char)0; // No sound pattern
+    for (int b = 0; b < 4; b++)
+      binaryBody += (char)((s.displayMs >> (8 * b)) & 0xFF);
+    binaryBody += (char)strlen(s.text);
+    binaryBody += s.text;
+  }
+}
+
+template <typename Stream>
+static void feedInChunks(Stream &stream, const std::string &body) {
+  const uint8_t *data = (const uint8_t *)body.data();
+  for (size_t i = 0; i < body.size(); i += CHUNK) {
+    size_t n = body.size() - i < CHUNK ? body.size() - i : CHUNK;
+    stream.feed(data + i, n);
+  }
+}
+
+static StreamInflater inflater; // 5.5 KB: keep it off the stack
+
+// Inflate a whole compressed body in HTTP_READ_CHUNK slices
+static bool inflateInChunks(const uint8_t *body, size_t size,
+                            StreamInflater::OutputHandler sink) {
+  inflater.begin(StreamInflater::FORMAT_GZIP);
+  inflater.onOutputData(sink);
+  for (size_t i = 0; i < size; i += CHUNK) {
+    size_t n = size - i < CHUNK ? size - i : CHUNK;
+    if (!inflater.feed(body + i, n))
+      return false;
+  }
+  return inflater.isFinished();
+}
+
+void setUp() { ArduinoMock::reset(); }
+
+void tearDown() {}
+
+void test_wire_sizes() {
+  printf("BENCH_WIRE,wire,json,%u\n", (unsigned)jsonBody.size());
+  printf("BENCH_WIRE,wire,binary,%u\n", (unsigned)binaryBody.size());
+  printf("BENCH_WIRE,wire,json_gzip,%u\n", (unsigned)sizeof(JSON_BATCH_GZIP));
+  printf("BENCH_WIRE,wire,binary_gzip,%u\n",
+         (unsigned)sizeof(BINARY_BATCH_GZIP));
+  TEST_ASSERT_LESS_THAN(jsonBody.size() / 2, binaryBody.size());
+  TEST_ASSERT_LESS_THAN(jsonBody.size() / 2, sizeof(JSON_BATCH_GZIP));
+}
+
+void test_inflate() {
+  // The vectors decode to exactly the bodies built above
+  std::string out;
+  auto collect = [&](const uint8_t *data, size_t len) {
+    out.append((const char *)data, len);
+    return true;
+  };
+  TEST_ASSERT_TRUE(
+      inflateInChunks(JSON_BATCH_GZIP, sizeof(JSON_BATCH_GZIP), collect));
+  TEST_ASSERT_TRUE(out == jsonBody);
+  out.clear();
+  TEST_ASSERT_TRUE(
+      inflateInChunks(BINARY_BATCH_GZIP, sizeof(BINARY_BATCH_GZIP), collect));
+  TEST_ASSERT_TRUE(out == binaryBody);
+
+  // Any split point works, down to single bytes
+  out.clear();
+  inflater.begin(StreamInflater::FORMAT_GZIP);
+  inflater.onOutputData(collect);
+  for (size_t i = 0; i < sizeof(JSON_BATCH_GZIP); i++)
+    TEST_ASSERT_TRUE(inflater.feed(JSON_BATCH_GZIP + i, 1));
+  TEST_ASSERT_TRUE(inflater.isFinished());
+  TEST_ASSERT_TRUE(out == jsonBody);
+
+  // A window too small for the stream is told apart from corrupt data,
+  // so the client can fetch the body again uncompressed
+  inflater.begin(StreamInflater::FORMAT_DEFLATE);
+  TEST_ASSERT_FALSE(
+      inflater.feed(WIDE_WINDOW_DEFLATE, sizeof(WIDE_WINDOW_DEFLATE)));
+  TEST_ASSERT_TRUE(inflater.isWindowExceeded());
+  inflater.begin(StreamInflater::FORMAT_GZIP);
+  TEST_ASSERT_FALSE(inflater.isWindowExceeded());
+
+  size_t produced = 0;
+  BenchHarness::run("wire", "inflate_json_gzip", ITERATIONS, [&]() {
+    inflateInChunks(JSON_BATCH_GZIP, sizeof(JSON_BATCH_GZIP),
+                    [&](const uint8_t *, size_t len) {
+                      produced += len;
+                      return true;
+                    });
+  });
+  BenchHarness::doNotOptimize(produced);
+}
+
+void test_decode_json() {
+  StaticJsonDocument<128> filter;
+  filter["Expression"] = true;
+  filter["BuzzerDuration"] = true;
+  filter["Text"] = true;
+  filter["DisplayDuration"] = true;
+
+  JsonArrayStream stream;
+  int decoded = 0;
+  int displayMsSum = 0;
+  stream.onElementComplete([&](const char *json, size_t len) {
+    // Same work as APIClient::parseStep
+    StaticJsonDocument<384> doc;
+    deserializeJson(doc, json, len, DeserializationOption::Filter(filter));
+    const char *expression = doc["Expression"];
+    const char *text = doc["Text"];
+    float display = doc["DisplayDuration"];
+    BenchHarness::doNotOptimize(expression);
+    BenchHarness::doNotOptimize(text);
+    displayMsSum += (int)(display * 1000);
+    decoded++;
+  });
+
+  BenchHarness::run("wire", "decode_json_batch", ITERATIONS, [&]() {
+    stream.reset();
+    feedInChunks(stream, jsonBody);
+  });
+
+  BenchHarness::run("wire", "decode_json_gzip_batch", ITERATIONS, [&]() {
+    stream.reset();
+    inflateInChunks(JSON_BATCH_GZIP, sizeof(JSON_BATCH_GZIP),
+                    [&](const uint8_t *data, size_t len) {
+                      stream.feed(data, len);
+                      return true;
+                    });
+  });
+
+  stream.reset();
+  decoded = 0;
+  displayMsSum = 0;
+  feedInChunks(stream, jsonBody);
+  TEST_ASSERT_TRUE(stream.isComplete());
+  TEST_ASSERT_EQUAL(BATCH_SIZE, decoded);
+  TEST_ASSERT_EQUAL(33000, displayMsSum);
+}
+
+void test_decode_binary() {
+  BinaryStepStream stream;
+  int decoded = 0;
+  int mismatches = 0;
+  stream.onStepComplete([&](const StepRecord &step) {
+    const SampleStep &s = BATCH[decoded % BATCH_SIZE];
+    if (step.expression != s.expressionId || step.beepMs != s.beepMs ||
+        step.soundPattern != 0 || (int)step.displayMs != s.displayMs ||
+        strcmp(step.text, s.text) != 0)
+      mismatches++;
+    decoded++;
+  });
+
+  BenchHarness::run("wire", "decode_binary_batch", ITERATIONS, [&]() {
+    stream.reset();
+    feedInChunks(stream, binaryBody);
+  });
+
+  TEST_ASSERT_TRUE(stream.isComplete());
+  TEST_ASSERT_EQUAL(0, mismatches);
+
+  // Every split point decodes the same batch
+  for (size_t cut = 1; cut < binaryBody.size(); cut++) {
+    stream.reset();
+    decoded = 0;
+    stream.feed((const uint8_t *)binaryBody.data(), cut);
+    stream.feed((const uint8_t *)binaryBody.data() + cut,
+                binaryBody.size() - cut);
+    TEST_ASSERT_TRUE(stream.isComplete());
+    TEST_ASSERT_EQUAL(BATCH_SIZE, decoded);
+  }
+  TEST_ASSERT_EQUAL(0, mismatches);
+}
+
+// A response stages its steps as they decode. Until the whole body is in
+// and released, the leftover drain APIClient::update() runs every loop
+// must not move any of them, and a failed fetch discards them all.
+void test_partial_body_not_queued() {
+  static SequenceQueue queue;
+  static StepBatch staging;
+  queue.clear();
+  staging.clear();
+  BinaryStepStream stream;
+  stream.onStepComplete([&](const StepRecord &record) {
+    SequenceStep step;
+    step.expression = Eye::expressionFromId(record.expression);
+    step.beepMs = record.beepMs;
+    step.soundPattern = record.soundPattern;
+    step.displayMs = record.displayMs;
+    step.setText(record.text);
+    staging.add(step);
+  });
+  const uint8_t *body = (const uint8_t *)binaryBody.data();
+  size_t half = binaryBody.size() / 2;
+
+  stream.feed(body, half);
+  TEST_ASSERT_GREATER_THAN(0, staging.getStaged());
+  staging.commitTo(queue); // Next loop, response still in flight
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  staging.discard(); // The fetch failed
+  TEST_ASSERT_TRUE(staging.isEmpty());
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  // The retry arrives whole: all of it is queued
+  stream.reset();
+  stream.feed(body, half);
+  stream.feed(body + half, binaryBody.size() - half);
+  TEST_ASSERT_TRUE(stream.isComplete());
+  staging.release();
+  TEST_ASSERT_EQUAL(BATCH_SIZE, staging.commitTo(queue));
+  TEST_ASSERT_EQUAL(BATCH_SIZE, queue.size());
+}
+
+int main() {
+  buildBodies();
+  UNITY_BEGIN();
+  RUN_TEST(test_wire_sizes);
+  RUN_TEST(test_inflate);
+  RUN_TEST(test_decode_json);
+  RUN_TEST(test_decode_binary);
+  RUN_TEST(test_partial_body_not_queued);
+  return UNITY_END();
+}
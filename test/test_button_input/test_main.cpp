@@ -0,0 +1,125 @@
+// ButtonInput gestures from time-stamped edges, on the native host build.
+// Run with: pio test -e native -f test_button_input -v
+//
+// Edges are fired through the pin interrupt at mock times; update() is
+// called late on purpose in some cases, the way a loop() blocked by a TLS
+// connect would drain the ring.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Input/ButtonInput.h"
+
+static const uint8_t PIN = D3;
+
+static ButtonInput button(PIN);
+static ButtonInput::Gesture got[8];
+static int gotCount;
+
+static void edge(unsigned long ms, int level) {
+  ArduinoMock::setMillis(ms);
+  ArduinoMock::setPin(PIN, level);
+}
+
+static void updateAt(unsigned long ms) {
+  ArduinoMock::setMillis(ms);
+  button.update(ms);
+  for (ButtonInput::Gesture g; (g = button.nextGesture()) != ButtonInput::NONE;)
+    if (gotCount < 8)
+      got[gotCount++] = g;
+}
+
+void setUp() {
+  ArduinoMock::reset();
+  button.begin();
+  button.reset(0);
+  gotCount = 0;
+}
+
+void tearDown() {}
+
+void test_tap_with_bounce() {
+  edge(1000, LOW);
+  edge(1003, HIGH);
+  edge(1005, LOW);
+  updateAt(1010);
+  edge(1100, HIGH);
+  edge(1104, LOW);
+  edge(1106, HIGH);
+  updateAt(1300);
+  TEST_ASSERT_EQUAL(0, gotCount); // Still inside the double-tap window
+  updateAt(1450);
+  TEST_ASSERT_EQUAL(1, gotCount);
+  TEST_ASSERT_EQUAL(ButtonInput::TAP, got[0]);
+}
+
+void test_glitch_is_ignored() {
+  edge(1000, LOW);
+  edge(1010, HIGH);
+  updateAt(1020);
+  updateAt(2000);
+  TEST_ASSERT_EQUAL(0, gotCount);
+}
+
+void test_double_tap_drained_late() {
+  edge(1000, LOW);
+  edge(1080, HIGH);
+  edge(1200, LOW);
+  edge(1280, HIGH);
+  updateAt(3000);
+  TEST_ASSERT_EQUAL(1, gotCount);
+  TEST_ASSERT_EQUAL(ButtonInput::DOUBLE_TAP, got[0]);
+}
+
+void test_taps_apart_drained_late() {
+  edge(1000, LOW);
+  edge(1080, HIGH);
+  edge(4000, LOW);
+  edge(4080, HIGH);
+  updateAt(6000);
+  TEST_ASSERT_EQUAL(2, gotCount);
+  TEST_ASSERT_EQUAL(ButtonInput::TAP, got[0]);
+  TEST_ASSERT_EQUAL(ButtonInput::TAP, got[1]);
+}
+
+void test_long_press_while_held() {
+  edge(1000, LOW);
+  updateAt(1500);
+  TEST_ASSERT_EQUAL(0, gotCount);
+  updateAt(1000 + INPUT_LONG_PRESS_MS);
+  TEST_ASSERT_EQUAL(1, gotCount);
+  TEST_ASSERT_EQUAL(ButtonInput::LONG_PRESS, got[0]);
+  edge(2500, HIGH);
+  updateAt(3000);
+  TEST_ASSERT_EQUAL(1, gotCount); // The release is not a tap
+}
+
+// Press and release both drained after the fact: still a long press, not
+// a tap (which main.cpp would take as "enter standby")
+void test_long_press_drained_late() {
+  edge(1000, LOW);
+  edge(1000 + INPUT_LONG_PRESS_MS + 200, HIGH);
+  updateAt(4000);
+  TEST_ASSERT_EQUAL(1, gotCount);
+  TEST_ASSERT_EQUAL(ButtonInput::LONG_PRESS, got[0]);
+}
+
+void test_reset_while_held() {
+  ArduinoMock::pinLevels[PIN] = LOW;
+  button.reset(1000);
+  edge(1200, HIGH);
+  updateAt(2000);
+  TEST_ASSERT_EQUAL(0, gotCount);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_tap_with_bounce);
+  RUN_TEST(test_glitch_is_ignored);
+  RUN_TEST(test_double_tap_drained_late);
+  RUN_TEST(test_taps_apart_drained_late);
+  RUN_TEST(test_long_press_while_held);
+  RUN_TEST(test_long_press_drained_late);
+  RUN_TEST(test_reset_while_held);
+  return UNITY_END();
+}
@@ -0,0 +1,369 @@
+// Golden-image rendering regression suite for the native host build.
+// Run with: pio test -e native -f test_render_golden -v
+//
+// Every case draws a full 128x64 frame (both eyes, plus a caption where
+// the case has one) and compares it pixel for pixel with a checked-in PBM
+// in golden/. Each case also has a budget of pixel writes, draw calls and
+// sprite bytes blitted, counted by the U8g2 stand-in, so it is the same on
+// every machine. The sprite cache must match live rasterization exactly
+// and be faster.
+//
+// After an intended change to the picture, rewrite the files with
+//   JUMBO_UPDATE_GOLDEN=1 pio test -e native -f test_render_golden
+// and review the new images (any PBM viewer) before committing them.
+// On a mismatch the frame that was drawn is saved as <case>.actual.pbm.
+//
+// Pixels come from the stand-in rasterizer (test/native/U8g2lib.h); fonts
+// are placeholder glyphs, so text goldens pin down layout, not typefaces.
+
+#include <BenchHarness.h>
+#include <unity.h>
+
+#include "Face/Eye.h"
+#include "TextBox.h"
+#include <stdlib.h>
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "test/test_render_golden/golden"
+#endif
+
+// The fixed-point eye math rounds differently mid-morph, so it has its own
+// set of images
+#if EYE_FIXED_POINT
+#define GOLDEN_SET GOLDEN_DIR "/fixed"
+#else
+#define GOLDEN_SET GOLDEN_DIR "/float"
+#endif
+
+static const int FRAME_BYTES = U8G2::WIDTH * U8G2::HEIGHT / 8;
+// Room for any case name, terminator included
+static const int CASE_NAME_MAX = 48;
+static const int TIMING_ITERATIONS = 2000;
+
+static const Eye::Expression EXPRESSIONS[] = {
+    Eye::EXPR_ANGRY, Eye::EXPR_HAPPY, Eye::EXPR_SHOCKED,
+    Eye::EXPR_SAD,   Eye::EXPR_CALM,  Eye::EXPR_SLEEP};
+static const char *EXPRESSION_NAMES[] = {"angry", "happy", "shocked",
+                                         "sad",   "calm",  "sleep"};
+
+// Upper bounds per frame, about 5% over the current cost. Tighten them
+// when rendering gets cheaper.
+struct RenderBudget {
+  unsigned long pixelWrites;
+  unsigned long drawCalls;
+  unsigned long bufferWrites; // Bytes blitted from the sprite cache
+};
+
+static const RenderBudget EXPRESSION_LIVE_BUDGET[] = {
+    {7900, 12, 0},  // angry
+    {9900, 12, 0},  // happy
+    {4900, 12, 0},  // shocked
+    {9400, 12, 0},  // sad
+    {9200, 12, 0},  // calm
+    {13400, 12, 0}, // sleep
+};
+// Sprites are ORed into the buffer a byte at a time (bufferWrites, zero
+// bytes skipped). Sleep is all lid: an empty sprite under the closed
+// blink lid (pixel writes).
+static const RenderBudget EXPRESSION_SPRITE_BUDGET[] = {
+    {0, 0, 420},  // angry
+    {0, 0, 170},  // happy
+    {0, 0, 780},  // shocked
+    {0, 0, 280},  // sad
+    {0, 0, 335},  // calm
+    {3700, 2, 0}, // sleep
+};
+static const RenderBudget BLINK_BUDGET = {12000, 14, 0};
+static const RenderBudget MORPH_BUDGET = {12400, 12, 0};
+static const RenderBudget CAPTION_BUDGET = {9800, 15, 0};
+
+static U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE, D1,
+                                                D2);
+
+static bool updateGolden() {
+  const char *v = getenv("JUMBO_UPDATE_GOLDEN");
+  return v && v[0] == '1';
+}
+
+// Binary PBM (P4), lit pixels white: rows of 16 bytes, MSB first,
+// 1 = black
+static void framePbmRows(const uint8_t *frame, uint8_t *rows) {
+  memset(rows, 0xFF, FRAME_BYTES);
+  for (int y = 0; y < U8G2::HEIGHT; y++)
+    for (int x = 0; x < U8G2::WIDTH; x++)
+      if (frame[(y >> 3) * U8G2::WIDTH + x] & (1 << (y & 7)))
+        rows[y * (U8G2::WIDTH / 8) + (x >> 3)] &= ~(0x80 >> (x & 7));
+}
+
+static bool writePbm(const char *path, const uint8_t *frame) {
+  static uint8_t rows[FRAME_BYTES];
+  framePbmRows(frame, rows);
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  fprintf(f, "P4\n%d %d\n", U8G2::WIDTH, U8G2::HEIGHT);
+  bool ok = fwrite(rows, 1, FRAME_BYTES, f) == (size_t)FRAME_BYTES;
+  fclose(f);
+  return ok;
+}
+
+static bool readPbm(const char *path, uint8_t *rows) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+  int w = 0, h = 0;
+  bool ok = fscanf(f, "P4 %d %d", &w, &h) == 2 && w == U8G2::WIDTH &&
+            h == U8G2::HEIGHT && fgetc(f) != EOF &&
+            fread(rows, 1, FRAME_BYTES, f) == (size_t)FRAME_BYTES;
+  fclose(f);
+  return ok;
+}
+
+// Compare (or, when updating, store) the current buffer
+static void checkGolden(const char *name) {
+  // GOLDEN_SET + "/" + name + ".actual.pbm"
+  char path[sizeof(GOLDEN_SET) + CASE_NAME_MAX + 12];
+  snprintf(path, sizeof(path), "%s/%s.pbm", GOLDEN_SET, name);
+  const uint8_t *frame = u8g2.getBufferPtr();
+
+  if (updateGolden()) {
+    TEST_ASSERT_TRUE_MESSAGE(writePbm(path, frame), path);
+    return;
+  }
+
+  static uint8_t expected[FRAME_BYTES];
+  static uint8_t actual[FRAME_BYTES];
+  // The path or name, plus up to 80 characters of text and numbers
+  char message[sizeof(path) + CASE_NAME_MAX + 80];
+  snprintf(message, sizeof(message),
+           "%s missing (run with JUMBO_UPDATE_GOLDEN=1)", path);
+  TEST_ASSERT_TRUE_MESSAGE(readPbm(path, expected), message);
+
+  framePbmRows(frame, actual);
+  int diff = 0, firstX = -1, firstY = -1;
+  for (int y = 0; y < U8G2::HEIGHT; y++) {
+    for (int x = 0; x < U8G2::WIDTH; x++) {
+      int i = y * (U8G2::WIDTH / 8) + (x >> 3);
+      uint8_t bit = 0x80 >> (x & 7);
+      if ((expected[i] ^ actual[i]) & bit) {
+        if (diff++ == 0) {
+          firstX = x;
+          firstY = y;
+        }
+      }
+    }
+  }
+  if (diff) {
+    snprintf(path, sizeof(path), "%s/%s.actual.pbm", GOLDEN_SET, name);
+    writePbm(path, frame);
+    snprintf(message, sizeof(message),
+             "%s: %d pixels differ, first at (%d,%d); drawn frame in %s",
+             name, diff, firstX, firstY, path);
+    TEST_FAIL_MESSAGE(message);
+  }
+}
+
+static void checkBudget(const char *name, const RenderBudget &budget) {
+  printf("GOLDEN_COST,%s,%lu,%lu,%lu\n", name, u8g2.stats.pixelWrites,
+         u8g2.stats.drawCalls, u8g2.stats.bufferWrites);
+  char message[CASE_NAME_MAX + 80];
+  snprintf(message, sizeof(message), "%s: %lu pixel writes (budget %lu)",
+           name, u8g2.stats.pixelWrites, budget.pixelWrites);
+  TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(budget.pixelWrites,
+                                    u8g2.stats.pixelWrites, message);
+  snprintf(message, sizeof(message), "%s: %lu draw calls (budget %lu)", name,
+           u8g2.stats.drawCalls, budget.drawCalls);
+  TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(budget.drawCalls, u8g2.stats.drawCalls,
+                                    message);
+  snprintf(message, sizeof(message), "%s: %lu buffer writes (budget %lu)",
+           name, u8g2.stats.bufferWrites, budget.bufferWrites);
+  TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(budget.bufferWrites,
+                                    u8g2.stats.bufferWrites, message);
+}
+
+// The face as JumboController lays it out
+struct Face {
+  Eye left;
+  Eye right;
+
+  Face() : left(32, 26, 20, true), right(96, 26, 20, false) {}
+
+  void setExpression(Eye::Expression e, int duration) {
+    left.setExpression(e, duration);
+    right.setExpression(e, duration);
+  }
+  void blink() {
+    left.blink();
+    right.blink();
+  }
+  void update() {
+    left.update();
+    right.update();
+  }
+  void draw() {
+    left.draw(u8g2);
+    right.draw(u8g2);
+  }
+};
+
+// Draw one frame from scratch with fresh counters
+template <typename Fn> static void renderFrame(Fn drawFn) {
+  u8g2.clearBuffer();
+  u8g2.resetStats();
+  drawFn();
+}
+
+void setUp() {
+  ArduinoMock::reset();
+  u8g2.clearBuffer();
+  u8g2.resetStats();
+}
+
+void tearDown() {}
+
+// Settled expressions: live rasterization, then the sprite cache, which
+// must give the same picture for less work
+void test_golden_expressions() {
+  static EyeSpriteCache leftSprites;
+  static EyeSpriteCache rightSprites;
+
+  for (int i = 0; i < Eye::EXPRESSION_COUNT; i++) {
+    Face face;
+    face.setExpression(EXPRESSIONS[i], 0);
+    face.update();
+
+    char name[CASE_NAME_MAX - 8]; // Leaves room for "_sprite"
+    char spriteName[CASE_NAME_MAX];
+    snprintf(name, sizeof(name), "expr_%s", EXPRESSION_NAMES[i]);
+    snprintf(spriteName, sizeof(spriteName), "%s_sprite", name);
+
+    renderFrame([&]() { face.draw(); });
+    checkGolden(name);
+    checkBudget(name, EXPRESSION_LIVE_BUDGET[i]);
+    BenchHarness::Result live = BenchHarness::run(
+        "golden", name, TIMING_ITERATIONS, [&]() { face.draw(); });
+
+    face.left.buildSprites(u8g2, leftSprites);
+    face.right.buildSprites(u8g2, rightSprites);
+    renderFrame([&]() { face.draw(); });
+    checkGolden(name); // Same picture as the live frame
+    checkBudget(spriteName, EXPRESSION_SPRITE_BUDGET[i]);
+    BenchHarness::Result sprite = BenchHarness::run(
+        "golden", spriteName, TIMING_ITERATIONS, [&]() { face.draw(); });
+    TEST_ASSERT_TRUE_MESSAGE(sprite.nsPerIter < live.nsPerIter, spriteName);
+  }
+}
+
+// Blink phases of Eye::update (80 ms closing, 50 ms closed, 80 ms
+// opening), drawn live and from the sprite cache
+void test_golden_blink() {
+  static EyeSpriteCache leftSprites;
+  static EyeSpriteCache rightSprites;
+  // ms after blink(), and the phase name
+  static const struct {
+    unsigned long ms;
+    const char *name;
+  } phases[] = {{20, "closing_25"},
+                {40, "closing_50"},
+                {60, "closing_75"},
+                {100, "closed"},
+                {170, "opening_50"}};
+
+  for (int cached = 0; cached < 2; cached++) {
+    for (const auto &phase : phases) {
+      ArduinoMock::reset();
+      Face face;
+      face.setExpression(Eye::EXPR_CALM, 0);
+      if (cached) {
+        face.left.buildSprites(u8g2, leftSprites);
+        face.right.buildSprites(u8g2, rightSprites);
+      }
+      face.update();
+      face.blink();
+      // Step through like loop() would, so the state machine advances
+      for (unsigned long t = 0; t < phase.ms; t += 10) {
+        ArduinoMock::advanceMillis(10);
+        face.update();
+      }
+
+      char name[CASE_NAME_MAX];
+      snprintf(name, sizeof(name), "blink_%s", phase.name);
+      renderFrame([&]() { face.draw(); });
+      checkGolden(name);
+      if (!cached) {
+        checkBudget(name, BLINK_BUDGET);
+      }
+    }
+  }
+}
+
+// Mid-morph frames of setExpression: calm to every expression halfway,
+// and calm to angry at each quarter
+void test_golden_morph() {
+  static const struct {
+    Eye::Expression to;
+    unsigned long ms; // Of a 400 ms morph
+  } morphs[] = {{Eye::EXPR_ANGRY, 100},   {Eye::EXPR_ANGRY, 200},
+                {Eye::EXPR_ANGRY, 300},   {Eye::EXPR_HAPPY, 200},
+                {Eye::EXPR_SHOCKED, 200}, {Eye::EXPR_SAD, 200},
+                {Eye::EXPR_SLEEP, 200}};
+
+  for (const auto &morph : morphs) {
+    ArduinoMock::reset();
+    Face face;
+    face.setExpression(Eye::EXPR_CALM, 0);
+    face.update();
+    face.setExpression(morph.to, 400);
+    ArduinoMock::advanceMillis(morph.ms);
+    face.update();
+
+    char name[CASE_NAME_MAX];
+    snprintf(name, sizeof(name), "morph_calm_%s_%lu",
+             EXPRESSION_NAMES[morph.to], morph.ms * 100 / 400);
+    renderFrame([&]() { face.draw(); });
+    checkGolden(name);
+    checkBudget(name, MORPH_BUDGET);
+  }
+}
+
+// Captions under the eyes (left aligned, wrapped) and the centred status
+// line, as JumboController places them
+void test_golden_captions() {
+  static const struct {
+    const char *name;
+    const char *text;
+    bool caption; // Caption box at the bottom, else the status line
+  } cases[] = {
+      {"caption_short", "Hello World!", true},
+      {"caption_two_lines", "The quick brown fox jumps over the lazy dog",
+       true},
+      {"caption_three_lines",
+       "Pack my box with five dozen liquor jugs and then some more", true},
+      {"status_wrapped", "Connecting to wifi... please wait", false},
+  };
+
+  for (const auto &c : cases) {
+    Face face;
+    face.setExpression(Eye::EXPR_CALM, 0);
+    face.update();
+    TextBox box = c.caption ? TextBox(0, 50, 12, 128, ALIGN_LEFT)
+                            : TextBox(0, 0, 12, 128, ALIGN_CENTER);
+    box.setText(c.text);
+
+    renderFrame([&]() {
+      face.draw();
+      box.draw(u8g2);
+    });
+    checkGolden(c.name);
+    checkBudget(c.name, CAPTION_BUDGET);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_golden_expressions);
+  RUN_TEST(test_golden_blink);
+  RUN_TEST(test_golden_morph);
+  RUN_TEST(test_golden_captions);
+  return UNITY_END();
+}
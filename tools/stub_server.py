@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Local stand-in for the Jumbo server, for testing the firmware's network path.
+
+    python3 tools/stub_server.py --port 8000
+
+Then point Config.h at it:
+
+    API_URL        "http://<this-machine>:8000/jumbo-ai/brain"
+    API_STREAM_URL "http://<this-machine>:8000/jumbo-ai/stream"
+
+Endpoints:
+    POST /jumbo-ai/brain   one batch of steps (JSON, or the packed binary
+                           format when the Accept header asks for it),
+                           with an ETag; If-None-Match on it returns 304
+    GET  /jumbo-ai/stream  Server-Sent Events: one "step" event every
+                           --push-interval seconds, ": ping" in between
+
+Only the standard library is used.
+"""
+
+import argparse
+import itertools
+import json
+import struct
+import time
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+BINARY_TYPE = "application/x-jumbo-steps"
+EXPRESSIONS = ["angry", "happy", "shocked", "sad", "calm", "sleep"]
+SOUNDS = ["none", "chirp", "double", "alert", "rise", "fall"]  # src/SoundPatterns.h
+
+SAMPLE_STEPS = [
+    {"Expression": "happy", "Text": "Good morning!", "BuzzerDuration": 0, "Sound": "rise", "DisplayDuration": 3.0},
+    {"Expression": "calm", "Text": "Coffee first, then code.", "BuzzerDuration": 0, "DisplayDuration": 4.0},
+    {"Expression": "shocked", "Text": "Is it Monday already?", "BuzzerDuration": 0.5, "DisplayDuration": 2.0},
+    {"Expression": "sad", "Text": "The build is red.", "BuzzerDuration": 0, "Sound": "fall", "DisplayDuration": 3.5},
+    {"Expression": "happy", "Text": "Fixed it.", "BuzzerDuration": 0.1, "DisplayDuration": 2.5},
+]
+
+
+def encode_binary(steps):
+    """Packed step format, see src/Network/BinaryStepStream.h."""
+    out = bytearray(b"JS\x02")
+    for step in steps:
+        text = step["Text"].encode("utf-8")[:255]
+        out += struct.pack(
+            "<BHBIB",
+            EXPRESSIONS.index(step["Expression"].lower()),
+            int(round(step["BuzzerDuration"] * 1000)),
+            SOUNDS.index(step.get("Sound", "none")),
+            int(round(step["DisplayDuration"] * 1000)),
+            len(text),
+        )
+        out += text
+    return bytes(out)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # Keep-alive, like the real server
+    server_version = "JumboStub/1"
+
+    def log_message(self, fmt, *args):
+        print("%s %s" % (self.address_string(), fmt % args), flush=True)
+
+    def authorized(self):
+        token = self.server.options.token
+        if token and self.headers.get("Authorization") != "Bearer " + token:
+            self.send_error(401)
+            return False
+        return True
+
+    def do_POST(self):
+        if self.path != self.server.options.brain_path:
+            self.send_error(404)
+            return
+        length = int(self.headers.get("Content-Length", 0))
+        request = json.loads(self.rfile.read(length) or b"{}")
+        if not self.authorized():
+            return
+        print("  message: %r" % request.get("message"), flush=True)
+
+        # The batch changes every --change-every seconds; its ETag names
+        # that version, so a client that already has it gets a 304
+        options = self.server.options
+        version = int(time.time() // options.change_every)
+        binary = BINARY_TYPE in self.headers.get("Accept", "")
+        etag = '"v%d%s"' % (version, "-bin" if binary else "")
+        if self.headers.get("If-None-Match") == etag:
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.end_headers()
+            return
+
+        start = version % len(SAMPLE_STEPS)
+        steps = (SAMPLE_STEPS[start:] + SAMPLE_STEPS[:start])[: options.batch]
+        if binary:
+            body, content_type = encode_binary(steps), BINARY_TYPE
+        else:
+            body, content_type = json.dumps(steps).encode(), "application/json"
+
+        # Compress with a 4 KB window, the most the firmware keeps
+        encoding = None
+        if options.compress and "gzip" in self.headers.get("Accept-Encoding", ""):
+            compressor = zlib.compressobj(9, zlib.DEFLATED, 16 + 12)
+            body = compressor.compress(body) + compressor.flush()
+            encoding = "gzip"
+
+        self.send_response(200)
+        self.send_header("ETag", etag)
+        self.send_header("Content-Type", content_type)
+        if encoding:
+            self.send_header("Content-Encoding", encoding)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_GET(self):
+        if self.path != self.server.options.stream_path:
+            self.send_error(404)
+            return
+        if not self.authorized():
+            return
+
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream")
+        self.send_header("Cache-Control", "no-cache")
+        self.send_header("Connection", "close")
+        self.end_headers()
+        self.close_connection = True
+
+        options = self.server.options
+        steps = itertools.cycle(SAMPLE_STEPS)
+        next_step = time.monotonic() + options.push_interval
+        try:
+            self.wfile.write(b": hello\n\n")
+            self.wfile.flush()
+            while True:
+                wait = next_step - time.monotonic()
+                if wait > 0:
+                    time.sleep(min(wait, options.ping_interval))
+                    if time.monotonic() < next_step:
+                        self.wfile.write(b": ping\n\n")
+                        self.wfile.flush()
+                        continue
+                event = "event: step\ndata: %s\n\n" % json.dumps(next(steps))
+                self.wfile.write(event.encode())
+                self.wfile.flush()
+                next_step += options.push_interval
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8000)
+    parser.add_argument("--token", default="", help="require this bearer token")
+    parser.add_argument("--batch", type=int, default=3, help="steps per POST")
+    parser.add_argument("--change-every", type=float, default=60.0,
+                        help="seconds until the POST batch (and its ETag) changes")
+    parser.add_argument("--compress", action="store_true",
+                        help="gzip POST responses when the client accepts it")
+    parser.add_argument("--push-interval", type=float, default=10.0)
+    parser.add_argument("--ping-interval", type=float, default=15.0)
+    parser.add_argument("--brain-path", default="/jumbo-ai/brain")
+    parser.add_argument("--stream-path", default="/jumbo-ai/stream")
+    options = parser.parse_args()
+
+    server = ThreadingHTTPServer((options.host, options.port), Handler)
+    server.daemon_threads = True
+    server.options = options
+    print("Listening on %s:%d" % (options.host, options.port), flush=True)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()